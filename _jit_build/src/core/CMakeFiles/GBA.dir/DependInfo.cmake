@@ -0,0 +1,38 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/core/apu/apu.cpp" "src/core/CMakeFiles/GBA.dir/apu/apu.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/apu/apu.cpp.o.d"
+  "/root/repo/src/core/arm7tdmi/arm/arm_jit.cpp" "src/core/CMakeFiles/GBA.dir/arm7tdmi/arm/arm_jit.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/arm7tdmi/arm/arm_jit.cpp.o.d"
+  "/root/repo/src/core/arm7tdmi/arm7tdmi.cpp" "src/core/CMakeFiles/GBA.dir/arm7tdmi/arm7tdmi.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/arm7tdmi/arm7tdmi.cpp.o.d"
+  "/root/repo/src/core/arm7tdmi/jit.cpp" "src/core/CMakeFiles/GBA.dir/arm7tdmi/jit.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/arm7tdmi/jit.cpp.o.d"
+  "/root/repo/src/core/arm7tdmi/thumb/thumb_jit.cpp" "src/core/CMakeFiles/GBA.dir/arm7tdmi/thumb/thumb_jit.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/arm7tdmi/thumb/thumb_jit.cpp.o.d"
+  "/root/repo/src/core/backup/backup.cpp" "src/core/CMakeFiles/GBA.dir/backup/backup.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/backup/backup.cpp.o.d"
+  "/root/repo/src/core/backup/eeprom.cpp" "src/core/CMakeFiles/GBA.dir/backup/eeprom.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/backup/eeprom.cpp.o.d"
+  "/root/repo/src/core/backup/flash.cpp" "src/core/CMakeFiles/GBA.dir/backup/flash.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/backup/flash.cpp.o.d"
+  "/root/repo/src/core/backup/sram.cpp" "src/core/CMakeFiles/GBA.dir/backup/sram.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/backup/sram.cpp.o.d"
+  "/root/repo/src/core/bios.cpp" "src/core/CMakeFiles/GBA.dir/bios.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/bios.cpp.o.d"
+  "/root/repo/src/core/bios_hle.cpp" "src/core/CMakeFiles/GBA.dir/bios_hle.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/bios_hle.cpp.o.d"
+  "/root/repo/src/core/dma.cpp" "src/core/CMakeFiles/GBA.dir/dma.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/dma.cpp.o.d"
+  "/root/repo/src/core/gba.cpp" "src/core/CMakeFiles/GBA.dir/gba.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/gba.cpp.o.d"
+  "/root/repo/src/core/gpio.cpp" "src/core/CMakeFiles/GBA.dir/gpio.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/gpio.cpp.o.d"
+  "/root/repo/src/core/mem.cpp" "src/core/CMakeFiles/GBA.dir/mem.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/mem.cpp.o.d"
+  "/root/repo/src/core/ppu/ppu.cpp" "src/core/CMakeFiles/GBA.dir/ppu/ppu.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/ppu/ppu.cpp.o.d"
+  "/root/repo/src/core/ppu/render.cpp" "src/core/CMakeFiles/GBA.dir/ppu/render.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/ppu/render.cpp.o.d"
+  "/root/repo/src/core/rtc.cpp" "src/core/CMakeFiles/GBA.dir/rtc.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/rtc.cpp.o.d"
+  "/root/repo/src/core/scheduler.cpp" "src/core/CMakeFiles/GBA.dir/scheduler.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/scheduler.cpp.o.d"
+  "/root/repo/src/core/timer.cpp" "src/core/CMakeFiles/GBA.dir/timer.cpp.o" "gcc" "src/core/CMakeFiles/GBA.dir/timer.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
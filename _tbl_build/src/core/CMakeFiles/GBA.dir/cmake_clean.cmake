@@ -0,0 +1,47 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/GBA.dir/apu/apu.cpp.o"
+  "CMakeFiles/GBA.dir/apu/apu.cpp.o.d"
+  "CMakeFiles/GBA.dir/arm7tdmi/arm/arm_table.cpp.o"
+  "CMakeFiles/GBA.dir/arm7tdmi/arm/arm_table.cpp.o.d"
+  "CMakeFiles/GBA.dir/arm7tdmi/arm7tdmi.cpp.o"
+  "CMakeFiles/GBA.dir/arm7tdmi/arm7tdmi.cpp.o.d"
+  "CMakeFiles/GBA.dir/arm7tdmi/thumb/thumb_table.cpp.o"
+  "CMakeFiles/GBA.dir/arm7tdmi/thumb/thumb_table.cpp.o.d"
+  "CMakeFiles/GBA.dir/backup/backup.cpp.o"
+  "CMakeFiles/GBA.dir/backup/backup.cpp.o.d"
+  "CMakeFiles/GBA.dir/backup/eeprom.cpp.o"
+  "CMakeFiles/GBA.dir/backup/eeprom.cpp.o.d"
+  "CMakeFiles/GBA.dir/backup/flash.cpp.o"
+  "CMakeFiles/GBA.dir/backup/flash.cpp.o.d"
+  "CMakeFiles/GBA.dir/backup/sram.cpp.o"
+  "CMakeFiles/GBA.dir/backup/sram.cpp.o.d"
+  "CMakeFiles/GBA.dir/bios.cpp.o"
+  "CMakeFiles/GBA.dir/bios.cpp.o.d"
+  "CMakeFiles/GBA.dir/bios_hle.cpp.o"
+  "CMakeFiles/GBA.dir/bios_hle.cpp.o.d"
+  "CMakeFiles/GBA.dir/dma.cpp.o"
+  "CMakeFiles/GBA.dir/dma.cpp.o.d"
+  "CMakeFiles/GBA.dir/gba.cpp.o"
+  "CMakeFiles/GBA.dir/gba.cpp.o.d"
+  "CMakeFiles/GBA.dir/gpio.cpp.o"
+  "CMakeFiles/GBA.dir/gpio.cpp.o.d"
+  "CMakeFiles/GBA.dir/mem.cpp.o"
+  "CMakeFiles/GBA.dir/mem.cpp.o.d"
+  "CMakeFiles/GBA.dir/ppu/ppu.cpp.o"
+  "CMakeFiles/GBA.dir/ppu/ppu.cpp.o.d"
+  "CMakeFiles/GBA.dir/ppu/render.cpp.o"
+  "CMakeFiles/GBA.dir/ppu/render.cpp.o.d"
+  "CMakeFiles/GBA.dir/rtc.cpp.o"
+  "CMakeFiles/GBA.dir/rtc.cpp.o.d"
+  "CMakeFiles/GBA.dir/scheduler.cpp.o"
+  "CMakeFiles/GBA.dir/scheduler.cpp.o.d"
+  "CMakeFiles/GBA.dir/timer.cpp.o"
+  "CMakeFiles/GBA.dir/timer.cpp.o.d"
+  "libGBA.a"
+  "libGBA.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/GBA.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
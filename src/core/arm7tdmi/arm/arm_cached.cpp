@@ -0,0 +1,106 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "arm_table.hpp"
+#include "arm7tdmi/cached.hpp"
+#include "scheduler.hpp"
+
+namespace gba::arm7tdmi::arm {
+namespace {
+
+constexpr auto func_table = generate_function_table();
+
+// returns false if the frame ended or we exit arm
+inline auto dispatch(Gba& gba) -> bool
+{
+    gba.scheduler.cycles += gba.scheduler.elapsed;
+    gba.scheduler.elapsed = 0;
+
+    if (gba.scheduler.next_event_cycles <= gba.scheduler.cycles)
+    {
+        scheduler::fire(gba);
+
+        if (gba.scheduler.frame_end) [[unlikely]]
+        {
+            return false;
+        }
+    }
+
+    return !CPU.cpsr.T;
+}
+
+// same as fetch() but the opcode is read from the cache if it's there.
+// returns the handler for the opcode now in pipeline[1].
+inline auto fetch_cached(Gba& gba) -> cached::ArmFunc
+{
+    const auto addr = CPU.registers[PC_INDEX];
+    auto* slot = gba.cached.get_slot(addr & ~0x3);
+
+    if (slot != nullptr && slot->state == cached::State::ARM) [[likely]]
+    {
+        gba.scheduler.tick(slot->cycles);
+        CPU.pipeline[1] = slot->opcode;
+        return slot->arm;
+    }
+
+    const auto opcode = mem::read32(gba, addr);
+    const auto func = func_table[decode_template(opcode)];
+    CPU.pipeline[1] = opcode;
+
+    // gpio and eeprom are handled by functions so they can't be cached
+    if (slot != nullptr && gba.rmap[mem::get_read_page(addr)].array != nullptr)
+    {
+        slot->arm = func;
+        slot->opcode = opcode;
+        slot->cycles = mem::get_access_timing(addr, 4);
+        slot->state = cached::State::ARM;
+    }
+
+    return func;
+}
+
+struct Decoded
+{
+    cached::ArmFunc func;
+    u32 opcode;
+};
+
+} // namespace
+
+// only returns on frame end or when the cpu switches to thumb.
+auto execute(Gba& gba) -> void
+{
+    // handlers of the opcodes in the pipeline, these are checked against
+    // the pipeline before use as it may have been refilled (branch, irq).
+    Decoded decoded[2] =
+    {
+        { func_table[decode_template(CPU.pipeline[0])], CPU.pipeline[0] },
+        { func_table[decode_template(CPU.pipeline[1])], CPU.pipeline[1] },
+    };
+
+    for (;;)
+    {
+        const u32 opcode = CPU.pipeline[0];
+        const auto func = decoded[0].opcode == opcode ? decoded[0].func : func_table[decode_template(opcode)];
+
+        CPU.pipeline[0] = CPU.pipeline[1];
+        CPU.registers[PC_INDEX] += 4;
+        decoded[0] = decoded[1];
+        decoded[1].func = fetch_cached(gba);
+        decoded[1].opcode = CPU.pipeline[1];
+
+        const auto cond = bit::get_range<28, 31>(opcode);
+
+        if (cond == COND_AL || check_cond(gba, cond)) [[likely]]
+        {
+            func(gba, opcode);
+        }
+
+        if (!dispatch(gba))
+        {
+            return;
+        }
+    }
+}
+
+} // namespace gba::arm7tdmi::arm
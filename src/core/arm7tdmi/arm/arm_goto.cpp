@@ -40,7 +40,7 @@ inline auto fetch(Gba& gba) -> u32
     const auto opcode = CPU.pipeline[0];
     CPU.pipeline[0] = CPU.pipeline[1];
     gba.cpu.registers[PC_INDEX] += 4;
-    CPU.pipeline[1] = mem::read32(gba, get_pc(gba));
+    CPU.pipeline[1] = mem::read_code32(gba, get_pc(gba));
 
     return opcode;
 }
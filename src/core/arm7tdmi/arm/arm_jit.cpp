@@ -0,0 +1,133 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "arm_table.hpp"
+#include "arm7tdmi/jit.hpp"
+#include "scheduler.hpp"
+
+namespace gba::arm7tdmi::arm {
+namespace {
+
+constexpr auto func_table = generate_function_table();
+
+// returns false if the frame ended or we exit arm
+inline auto dispatch(Gba& gba) -> bool
+{
+    gba.scheduler.cycles += gba.scheduler.elapsed;
+    gba.scheduler.elapsed = 0;
+
+    if (gba.scheduler.next_event_cycles <= gba.scheduler.cycles)
+    {
+        scheduler::fire(gba);
+
+        if (gba.scheduler.frame_end) [[unlikely]]
+        {
+            return false;
+        }
+    }
+
+    return !CPU.cpsr.T;
+}
+
+inline auto execute_instruction(Gba& gba, const jit::ArmFunc func, const u32 opcode) -> void
+{
+    const auto cond = bit::get_range<28, 31>(opcode);
+
+    if (cond == COND_AL || check_cond(gba, cond)) [[likely]]
+    {
+        func(gba, opcode);
+    }
+}
+
+auto build_block(Gba& gba, jit::Block& block, const u32 pc) -> bool
+{
+    if (!jit::build_block(gba, block, pc, false))
+    {
+        return false;
+    }
+
+    for (u16 i = 0; i < block.count; i++)
+    {
+        auto& instruction = block.instructions[i];
+        instruction.arm = func_table[decode_template(instruction.opcode)];
+    }
+
+    // the pipeline may still have the old opcodes if the code was
+    // just written to, in which case, step until it's flushed.
+    if (block.instructions[0].opcode != CPU.pipeline[0] || (block.count > 1 && block.instructions[1].opcode != CPU.pipeline[1]))
+    {
+        block.valid = false;
+        return false;
+    }
+
+    return true;
+}
+
+// same as fetch() but avoids the read if the opcode is in the block
+inline auto fetch_from_block(Gba& gba, const jit::Block& block, const u16 index) -> void
+{
+    CPU.pipeline[0] = CPU.pipeline[1];
+    CPU.registers[PC_INDEX] += 4;
+
+    if (index + 2 < block.count)
+    {
+        gba.scheduler.tick(block.fetch_cycles);
+        CPU.pipeline[1] = block.instructions[index + 2].opcode;
+    }
+    else
+    {
+        CPU.pipeline[1] = mem::read32(gba, CPU.registers[PC_INDEX]);
+    }
+}
+
+} // namespace
+
+// unlike the other interpreters, this only returns on frame end
+// or when the cpu switches to thumb.
+auto execute(Gba& gba) -> void
+{
+    for (;;)
+    {
+        // pc points to pipeline[1], so the opcode about to run is one behind
+        const auto pc = CPU.registers[PC_INDEX] - 4;
+        auto& block = jit::get_block(gba, pc);
+
+        if (!jit::is_hit(block, pc, false) && !build_block(gba, block, pc)) [[unlikely]]
+        {
+            const auto opcode = fetch(gba);
+            execute_instruction(gba, func_table[decode_template(opcode)], opcode);
+
+            if (!dispatch(gba))
+            {
+                return;
+            }
+
+            continue;
+        }
+
+        // where pc should be after each instruction if we didn't branch
+        auto next_pc = pc + 8;
+
+        for (u16 i = 0; i < block.count; i++, next_pc += 4)
+        {
+            const auto& instruction = block.instructions[i];
+
+            fetch_from_block(gba, block, i);
+            execute_instruction(gba, instruction.arm, instruction.opcode);
+
+            if (!dispatch(gba))
+            {
+                return;
+            }
+
+            // exit the block if we branched, an interrupt fired
+            // or the block was written to.
+            if (CPU.registers[PC_INDEX] != next_pc || block.is_stale())
+            {
+                break;
+            }
+        }
+    }
+}
+
+} // namespace gba::arm7tdmi::arm
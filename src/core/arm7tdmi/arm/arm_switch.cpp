@@ -4143,23 +4143,47 @@ inline auto fetch(Gba& gba) -> u32
     const auto opcode = CPU.pipeline[0];
     CPU.pipeline[0] = CPU.pipeline[1];
     gba.cpu.registers[PC_INDEX] += 4;
-    CPU.pipeline[1] = mem::read32(gba, get_pc(gba));
+    CPU.pipeline[1] = mem::read_code32(gba, get_pc(gba));
 
     return opcode;
 }
-} // namespace
 
-auto execute(Gba& gba) -> void
+// returns false if the frame ended or we exit arm
+inline auto dispatch(Gba& gba) -> bool
 {
-    const auto opcode = fetch(gba);
-    const auto cond = bit::get_range<28, 31>(opcode);
+    gba.scheduler.cycles += gba.scheduler.elapsed;
+    gba.scheduler.elapsed = 0;
 
-    // it's highly likely that cond == 0xE, so we optimise for that
-    // before hitting the switch (slower).
-    if (cond == COND_AL || check_cond(gba, cond)) [[likely]]
+    if (gba.scheduler.next_event_cycles <= gba.scheduler.cycles)
     {
-        execute_switch(gba, opcode);
+        scheduler::fire(gba);
+
+        if (gba.scheduler.frame_end) [[unlikely]]
+        {
+            return false;
+        }
     }
+
+    return !CPU.cpsr.T;
+}
+
+} // namespace
+
+// only returns on frame end or when the cpu switches to thumb.
+auto execute(Gba& gba) -> void
+{
+    do
+    {
+        const auto opcode = fetch(gba);
+        const auto cond = bit::get_range<28, 31>(opcode);
+
+        // it's highly likely that cond == 0xE, so we optimise for that
+        // before hitting the switch (slower).
+        if (cond == COND_AL || check_cond(gba, cond)) [[likely]]
+        {
+            execute_switch(gba, opcode);
+        }
+    } while (dispatch(gba));
 }
 
 } // namespace gba::arm7tdmi::arm
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "arm7tdmi/arm7tdmi.hpp"
+#include "arm7tdmi/idle.hpp"
 #include "bit.hpp"
 #include "gba.hpp"
 
@@ -23,6 +24,12 @@ auto branch(Gba& gba, const u32 opcode) -> void
     }
 
     set_pc(gba, pc + offset);
+
+    // a loop can't have a call in it, so only check plain branches
+    if (!L && offset < 0 && !gba.idle.is_busy_loop(pc - 8, pc + offset, false))
+    {
+        idle::on_backward_branch(gba, pc - 8, pc + offset, false);
+    }
 }
 
 } // namespace
@@ -73,17 +73,17 @@ auto data_processing(Gba& gba, const u32 opcode, const u32 oprand1, const u32 op
     }
     else if constexpr(Op == ADC)
     {
-        const auto result = internal_adc<S>(gba, oprand1, oprand2, CPU.cpsr.C);
+        const auto result = internal_adc<S>(gba, oprand1, oprand2, CPU.flags.c);
         set_reg_data_processing(gba, Rd, result);
     }
     else if constexpr(Op == SBC)
     {
-        const auto result = internal_sbc<S>(gba, oprand1, oprand2, !CPU.cpsr.C);
+        const auto result = internal_sbc<S>(gba, oprand1, oprand2, !CPU.flags.c);
         set_reg_data_processing(gba, Rd, result);
     }
     else if constexpr(Op == RSC)
     {
-        const auto result = internal_sbc<S>(gba, oprand2, oprand1, !CPU.cpsr.C);
+        const auto result = internal_sbc<S>(gba, oprand2, oprand1, !CPU.flags.c);
         set_reg_data_processing(gba, Rd, result);
     }
     else if constexpr(Op == TST)
@@ -157,7 +157,7 @@ auto data_processing_imm(Gba& gba, const u32 opcode) -> void
     const auto oprand1 = get_reg(gba, Rn);
     const auto imm = bit::get_range<0, 7>(opcode);
     const auto rotate = bit::get_range<8, 11>(opcode) * 2;
-    const auto [oprand2, new_carry] = barrel::shift<barrel::type::ror>(imm, rotate, CPU.cpsr.C);
+    const auto [oprand2, new_carry] = barrel::shift<barrel::type::ror>(imm, rotate, CPU.flags.c);
 
     data_processing<S, Op>(gba, opcode, oprand1, oprand2, new_carry);
 }
@@ -33,8 +33,7 @@ auto multiply(Gba& gba, const u32 opcode) -> void
     if constexpr(S)
     {
         // todo: carry is set to random value???
-        CPU.cpsr.Z = result == 0;
-        CPU.cpsr.N = bit::is_set<31>(result);
+        CPU.flags.set_nz(result);
     }
 
     set_reg(gba, Rd, result);
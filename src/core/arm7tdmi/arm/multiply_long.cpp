@@ -43,8 +43,8 @@ auto multiply_long(Gba& gba, const u32 opcode) -> void
 
     if constexpr(S) // update flags
     {
-        CPU.cpsr.Z = result == 0;
-        CPU.cpsr.N = bit::is_set<63>(result);
+        CPU.flags.n = result >> 32;
+        CPU.flags.z = (result >> 32) | static_cast<u32>(result);
     }
 
     set_reg(gba, RdLo, result);
@@ -112,6 +112,26 @@ auto set_psr_from_u32(Gba& gba, Psr& psr, u32 value, const bool flag_write, cons
     }
 }
 
+// returns the cpsr with the flags filled in
+auto get_cpsr(const Gba& gba) -> Psr
+{
+    auto cpsr = CPU.cpsr;
+    cpsr.N = CPU.flags.N();
+    cpsr.Z = CPU.flags.Z();
+    cpsr.C = CPU.flags.c;
+    cpsr.V = CPU.flags.v;
+    return cpsr;
+}
+
+auto set_flags_from_psr(Gba& gba, const Psr psr) -> void
+{
+    // a psr can have both N and Z set, which no result can
+    CPU.flags.n = psr.N ? 0x80000000 : 0;
+    CPU.flags.z = !psr.Z;
+    CPU.flags.c = psr.C;
+    CPU.flags.v = psr.V;
+}
+
 enum class Exception
 {
     Reset,
@@ -127,7 +147,7 @@ enum class Exception
 auto exception(Gba& gba, const Exception e)
 {
     const auto state = get_state(gba);
-    const auto cpsr = CPU.cpsr;
+    const auto cpsr = get_cpsr(gba);
     const auto pc = get_pc(gba);
 
     u32 lr{};
@@ -236,21 +256,21 @@ auto check_cond(const Gba& gba, const u8 cond) -> bool
 {
     switch (cond & 0xF)
     {
-        case COND_EQ: return CPU.cpsr.Z;
-        case COND_NE: return !CPU.cpsr.Z;
-        case COND_CS: return CPU.cpsr.C;
-        case COND_CC: return !CPU.cpsr.C;
-        case COND_MI: return CPU.cpsr.N;
-        case COND_PL: return !CPU.cpsr.N;
-        case COND_VS: return CPU.cpsr.V;
-        case COND_VC: return !CPU.cpsr.V;
-
-        case COND_HI: return CPU.cpsr.C && !CPU.cpsr.Z;
-        case COND_LS: return !CPU.cpsr.C || CPU.cpsr.Z;
-        case COND_GE: return CPU.cpsr.N == CPU.cpsr.V;
-        case COND_LT: return CPU.cpsr.N != CPU.cpsr.V;
-        case COND_GT: return !CPU.cpsr.Z && (CPU.cpsr.N == CPU.cpsr.V);
-        case COND_LE: return CPU.cpsr.Z || (CPU.cpsr.N != CPU.cpsr.V);
+        case COND_EQ: return CPU.flags.Z();
+        case COND_NE: return !CPU.flags.Z();
+        case COND_CS: return CPU.flags.c;
+        case COND_CC: return !CPU.flags.c;
+        case COND_MI: return CPU.flags.N();
+        case COND_PL: return !CPU.flags.N();
+        case COND_VS: return CPU.flags.v;
+        case COND_VC: return !CPU.flags.v;
+
+        case COND_HI: return CPU.flags.c && !CPU.flags.Z();
+        case COND_LS: return !CPU.flags.c || CPU.flags.Z();
+        case COND_GE: return CPU.flags.N() == CPU.flags.v;
+        case COND_LT: return CPU.flags.N() != CPU.flags.v;
+        case COND_GT: return !CPU.flags.Z() && (CPU.flags.N() == CPU.flags.v);
+        case COND_LE: return CPU.flags.Z() || (CPU.flags.N() != CPU.flags.v);
         case COND_AL: return true;
 
         default:
@@ -264,14 +284,14 @@ auto refill_pipeline(Gba& gba) -> void
     switch (get_state(gba))
     {
         case State::ARM:
-            CPU.pipeline[0] = mem::read32(gba, get_pc(gba) + 0);
-            CPU.pipeline[1] = mem::read32(gba, get_pc(gba) + 4);
+            CPU.pipeline[0] = mem::read_code32(gba, get_pc(gba) + 0);
+            CPU.pipeline[1] = mem::read_code32(gba, get_pc(gba) + 4);
             gba.cpu.registers[PC_INDEX] += 4;
             break;
 
         case State::THUMB:
-            CPU.pipeline[0] = mem::read16(gba, get_pc(gba) + 0);
-            CPU.pipeline[1] = mem::read16(gba, get_pc(gba) + 2);
+            CPU.pipeline[0] = mem::read_code16(gba, get_pc(gba) + 0);
+            CPU.pipeline[1] = mem::read_code16(gba, get_pc(gba) + 2);
             gba.cpu.registers[PC_INDEX] += 2;
             break;
     }
@@ -352,7 +372,7 @@ auto change_mode(Gba& gba, const u8 old_mode, const u8 new_mode) -> void
 
 auto get_u32_from_cpsr(Gba& gba) -> u32
 {
-    return get_u32_from_psr(CPU.cpsr);
+    return get_u32_from_psr(get_cpsr(gba));
 }
 
 auto get_u32_from_spsr(Gba& gba) -> u32
@@ -364,7 +384,7 @@ auto get_u32_from_spsr(Gba& gba) -> u32
     {
         return get_u32_from_psr(CPU.spsr);
     }
-    return get_u32_from_psr(CPU.cpsr);
+    return get_u32_from_psr(get_cpsr(gba));
 }
 
 auto load_spsr_mode_into_cpsr(Gba& gba) -> void
@@ -389,6 +409,7 @@ auto load_spsr_into_cpsr(Gba& gba) -> void
     if (old_mode != MODE_USER && old_mode != MODE_SYSTEM) [[likely]]
     {
         CPU.cpsr = CPU.spsr;
+        set_flags_from_psr(gba, CPU.spsr);
         change_mode(gba, old_mode, new_mode);
         schedule_interrupt(gba); // I may now be unset, enabling interrupts
     }
@@ -399,6 +420,12 @@ auto set_cpsr_from_u32(Gba& gba, const u32 value, const bool flag_write, const b
     const auto old_mode = get_mode(gba);
     set_psr_from_u32(gba, CPU.cpsr, value, flag_write, control_write);
     const auto new_mode = get_mode(gba);
+
+    if (flag_write)
+    {
+        set_flags_from_psr(gba, CPU.cpsr);
+    }
+
     change_mode(gba, old_mode, new_mode);
 }
 
@@ -71,7 +71,7 @@ enum class Interrupt : u16
 
 struct Psr
 {
-    // condition flags
+    // condition flags, for the cpsr these are kept in Arm7tdmi::flags
     bool N:1;     // negative, less than
     bool Z:1;     // zero
     bool C:1;     // carry, borrow, extend
@@ -84,6 +84,27 @@ struct Psr
     u8 M:5;  // mode
 };
 
+// nearly every alu op sets the flags, but most are overwritten before
+// anything reads them. so rather than packing them into the cpsr each
+// time, N and Z are kept as the result they're taken from, making them
+// a single store. they're only turned into bits when read.
+struct Flags
+{
+    u32 n; // N is bit 31 of this
+    u32 z{1}; // Z is set when this is 0
+    bool c;
+    bool v;
+
+    [[nodiscard]] auto N() const -> bool { return n >> 31; }
+    [[nodiscard]] auto Z() const -> bool { return z == 0; }
+
+    auto set_nz(const u32 result) -> void
+    {
+        n = result;
+        z = result;
+    }
+};
+
 struct Arm7tdmi
 {
     u32 pipeline[2];
@@ -91,6 +112,7 @@ struct Arm7tdmi
     u32 registers[16];
     Psr cpsr;
     Psr spsr;
+    Flags flags; // N, Z, C, V of the cpsr
 
     u32 banked_r8_r12[5]; // used for restoring r8-12 leaving fiq
     u32 banked_reg_usr[2]; // used for restoring r13-14 when entering usr/sys mode
@@ -108,6 +130,9 @@ struct Arm7tdmi
     Psr banked_spsr_und;
 
     bool halted;
+    // set while in hle IntrWait / VBlankIntrWait, as the swi is called
+    // again after each irq until the irq it's waiting for happens.
+    bool intr_wait;
 };
 
 #define CPU gba.cpu
@@ -171,10 +196,8 @@ enum class HaltType
     write,
     // bios hle of hlt to skip mode switching
     hle_halt,
-    // bios hle of waiting for vblank int until halt is exited
-    // hle_vblank_halt,
-    // bio hle of waiting for specific int until halt is exited
-    // hle_int_halt,
+    // bios hle of IntrWait / VBlankIntrWait, waiting for a specific irq
+    hle_intr_wait,
 };
 
 STATIC auto on_interrupt_event(Gba& gba) -> void;
@@ -0,0 +1,51 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "cached.hpp"
+#include "gba.hpp"
+#include <cstring>
+
+namespace gba::arm7tdmi::cached {
+
+auto flush(Gba& gba) -> void
+{
+    if (!gba.cached.iwram)
+    {
+        gba.cached.iwram = std::make_unique<Slot[]>(IWRAM_SLOTS);
+    }
+
+    if (!gba.cached.rom)
+    {
+        gba.cached.rom = std::make_unique<std::unique_ptr<Slot[]>[]>(ROM_PAGES);
+    }
+
+    for (u32 i = 0; i < IWRAM_SLOTS; i++)
+    {
+        gba.cached.iwram[i].state = State::EMPTY;
+    }
+
+    // the rom may have changed, so free the pages rather than
+    // clearing them, they're allocated again when run.
+    for (u32 i = 0; i < ROM_PAGES; i++)
+    {
+        gba.cached.rom[i].reset();
+    }
+}
+
+auto invalidate_changed(Gba& gba, const mem::Mem& mem) -> void
+{
+    if (!gba.cached.iwram)
+    {
+        return;
+    }
+
+    for (u32 offset = 0; offset < sizeof(mem.iwram); offset += 4)
+    {
+        if (std::memcmp(gba.mem.iwram + offset, mem.iwram + offset, 4))
+        {
+            gba.cached.on_iwram_write(0x03000000 + offset);
+        }
+    }
+}
+
+} // namespace gba::arm7tdmi::cached
@@ -0,0 +1,98 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include "fwd.hpp"
+#include "mem.hpp"
+#include <memory>
+
+// pre-decoded instruction cache used by INTERPRETER_CACHED.
+// every 16-bit slot of iwram and rom can hold the opcode along with
+// its resolved handler, so fetching an opcode that has already been
+// seen skips both the memory map and the decode.
+// arm opcodes are always stored in the slot of the word aligned address.
+namespace gba::arm7tdmi::cached {
+
+enum : u32
+{
+    // rom slots are allocated a page at a time on first use
+    PAGE_SHIFT = 12,
+    PAGE_SIZE = 1 << PAGE_SHIFT,
+    PAGE_SLOTS = PAGE_SIZE >> 1,
+    ROM_PAGES = mem::ROM_SIZE >> PAGE_SHIFT,
+    IWRAM_SLOTS = mem::IWRAM_SIZE >> 1,
+};
+
+using ArmFunc = void(*)(Gba& gba, u32 opcode);
+using ThumbFunc = void(*)(Gba& gba, u16 opcode);
+
+enum class State : u8
+{
+    EMPTY,
+    THUMB,
+    ARM,
+};
+
+struct Slot
+{
+    union
+    {
+        ArmFunc arm;
+        ThumbFunc thumb;
+    };
+
+    u32 opcode;
+    u8 cycles; // fetch cycles, the timings are fixed per region
+    State state;
+};
+
+struct Cache
+{
+    // both are allocated on flush(), empty for the other interpreters
+    std::unique_ptr<Slot[]> iwram;
+    std::unique_ptr<std::unique_ptr<Slot[]>[]> rom;
+
+    // returns nullptr if addr isn't in iwram or rom
+    [[nodiscard]] auto get_slot(const u32 addr) -> Slot*
+    {
+        switch ((addr >> 24) & 0xF)
+        {
+            case 0x3:
+                return &iwram[(addr & mem::IWRAM_MASK) >> 1];
+
+            case 0x8: case 0x9: case 0xA: case 0xB: case 0xC: case 0xD:
+            {
+                const auto rom_addr = addr & mem::ROM_MASK;
+                auto& page = rom[rom_addr >> PAGE_SHIFT];
+
+                if (!page) [[unlikely]]
+                {
+                    page = std::make_unique<Slot[]>(PAGE_SLOTS);
+                }
+
+                return &page[(rom_addr & (PAGE_SIZE - 1)) >> 1];
+            }
+
+            default:
+                return nullptr;
+        }
+    }
+
+    // called on every write to iwram, clears both slots of the word
+    // so that a half of an arm opcode being written is also caught.
+    auto on_iwram_write(const u32 addr) -> void
+    {
+        const auto index = (addr & mem::IWRAM_MASK & ~0x3) >> 1;
+        iwram[index + 0].state = State::EMPTY;
+        iwram[index + 1].state = State::EMPTY;
+    }
+};
+
+// empties every slot, called on reset and loadstate
+STATIC auto flush(Gba& gba) -> void;
+// empties the iwram slots that differ from mem, called before
+// restoring a snapshot as that doesn't go through the write handlers.
+STATIC auto invalidate_changed(Gba& gba, const mem::Mem& mem) -> void;
+
+} // namespace gba::arm7tdmi::cached
@@ -24,10 +24,9 @@ constexpr auto internal_add(Gba& gba, const u32 a, const u32 b) -> u32
 
     if constexpr(modify_flags)
     {
-        CPU.cpsr.Z = result == 0;
-        CPU.cpsr.C = static_cast<u64>(a) + static_cast<u64>(b) > UINT32_MAX;
-        CPU.cpsr.N = bit::is_set<31>(result);
-        CPU.cpsr.V = calc_vflag(a, b, result);
+        CPU.flags.set_nz(result);
+        CPU.flags.c = static_cast<u64>(a) + static_cast<u64>(b) > UINT32_MAX;
+        CPU.flags.v = calc_vflag(a, b, result);
     }
 
     return result;
@@ -41,10 +40,9 @@ constexpr auto internal_adc(Gba& gba, const u32 a, const u32 b, const bool carry
 
     if constexpr(modify_flags)
     {
-        CPU.cpsr.Z = result == 0;
-        CPU.cpsr.C = (static_cast<u64>(a) + static_cast<u64>(b) + carry) > UINT32_MAX;
-        CPU.cpsr.N = bit::is_set<31>(result);
-        CPU.cpsr.V = calc_vflag(a, b, result);
+        CPU.flags.set_nz(result);
+        CPU.flags.c = (static_cast<u64>(a) + static_cast<u64>(b) + carry) > UINT32_MAX;
+        CPU.flags.v = calc_vflag(a, b, result);
     }
 
     return result;
@@ -57,10 +55,9 @@ constexpr auto internal_sub(Gba& gba, const u32 a, const u32 b) -> u32
 
     if constexpr(modify_flags)
     {
-        CPU.cpsr.Z = result == 0;
-        CPU.cpsr.C = a >= b;
-        CPU.cpsr.N = bit::is_set<31>(result);
-        CPU.cpsr.V = calc_vflag(a, ~b, result);
+        CPU.flags.set_nz(result);
+        CPU.flags.c = a >= b;
+        CPU.flags.v = calc_vflag(a, ~b, result);
     }
 
     return result;
@@ -73,10 +70,9 @@ constexpr auto internal_sbc(Gba& gba, const u32 a, const u32 b, const bool carry
 
     if constexpr(modify_flags)
     {
-        CPU.cpsr.Z = result == 0;
-        CPU.cpsr.C = a >= static_cast<u64>(b) + carry; // cast because b could overflow with carry added
-        CPU.cpsr.N = bit::is_set<31>(result);
-        CPU.cpsr.V = calc_vflag(a, ~b, result);
+        CPU.flags.set_nz(result);
+        CPU.flags.c = a >= static_cast<u64>(b) + carry; // cast because b could overflow with carry added
+        CPU.flags.v = calc_vflag(a, ~b, result);
     }
 
     return result;
@@ -87,9 +83,8 @@ constexpr auto set_logical_flags(Gba& gba, const u32 result, const bool carry) -
 {
     if constexpr(modify_flags)
     {
-        CPU.cpsr.Z = result == 0;
-        CPU.cpsr.C = carry;
-        CPU.cpsr.N = bit::is_set<31>(result);
+        CPU.flags.set_nz(result);
+        CPU.flags.c = carry;
     }
 }
 
@@ -99,8 +94,7 @@ constexpr auto set_logical_flags_without_carry(Gba& gba, const u32 result) -> vo
 {
     if constexpr(modify_flags)
     {
-        CPU.cpsr.Z = result == 0;
-        CPU.cpsr.N = bit::is_set<31>(result);
+        CPU.flags.set_nz(result);
     }
 }
 
@@ -111,7 +105,7 @@ template<
 constexpr auto data_processing_reg_shift(Gba& gba, const u32 opcode, u32& oprand1, const u8 Rn) -> barrel::shift_result
 {
     const auto Rm = bit::get_range<0, 3>(opcode);
-    const auto old_carry = CPU.cpsr.C;
+    const auto old_carry = CPU.flags.c;
     auto reg_to_shift = get_reg(gba, Rm);
 
     if constexpr(reg_shift)
@@ -0,0 +1,435 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "idle.hpp"
+#include "arm7tdmi/arm7tdmi.hpp"
+#include "bit.hpp"
+#include "gba.hpp"
+#include "mem.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <ranges>
+
+namespace gba::arm7tdmi::idle {
+namespace {
+
+// registers are bits 0-15, flags are tracked as if they were registers
+constexpr u32 FLAG_N = 1 << 16;
+constexpr u32 FLAG_Z = 1 << 17;
+constexpr u32 FLAG_C = 1 << 18;
+constexpr u32 FLAG_V = 1 << 19;
+
+constexpr u32 FLAGS_NZ = FLAG_N | FLAG_Z;
+constexpr u32 FLAGS_ALL = FLAG_N | FLAG_Z | FLAG_C | FLAG_V;
+
+// the pc is the same every iteration, so reading it is fine
+constexpr u32 PC_BIT = 1 << PC_INDEX;
+
+// what an instruction reads and writes
+struct Usage
+{
+    u32 reads;
+    u32 writes;
+    bool ok; // false if the instruction isn't allowed in an idle loop
+};
+
+[[nodiscard]]
+constexpr auto reg(const u32 index) -> u32
+{
+    return 1U << index;
+}
+
+[[nodiscard]]
+constexpr auto get_cond_flags(const u8 cond) -> u32
+{
+    switch (cond & 0xF)
+    {
+        case COND_EQ: case COND_NE: return FLAG_Z;
+        case COND_CS: case COND_CC: return FLAG_C;
+        case COND_MI: case COND_PL: return FLAG_N;
+        case COND_VS: case COND_VC: return FLAG_V;
+        case COND_HI: case COND_LS: return FLAG_C | FLAG_Z;
+        case COND_GE: case COND_LT: return FLAG_N | FLAG_V;
+        case COND_GT: case COND_LE: return FLAG_Z | FLAG_N | FLAG_V;
+        default: return 0;
+    }
+}
+
+// only loads and alu ops that don't write the pc are allowed.
+// branches are only allowed if they exit the loop.
+[[nodiscard]]
+auto get_usage_thumb(const u16 opcode, const u32 addr, const u32 loop_start, const u32 loop_end) -> Usage
+{
+    const auto rd = opcode & 0x7;
+    const auto rs = (opcode >> 3) & 0x7;
+
+    // move shifted register, lsl #0 doesn't change carry
+    if ((opcode & 0xE000) == 0x0000 && (opcode & 0x1800) != 0x1800)
+    {
+        const auto lsl_0 = (opcode & 0x1FC0) == 0;
+        return { reg(rs), reg(rd) | FLAGS_NZ | (lsl_0 ? 0 : FLAG_C), true };
+    }
+
+    // add / subtract
+    if ((opcode & 0xF800) == 0x1800)
+    {
+        const auto immediate = opcode & 0x400;
+        const auto rn = (opcode >> 6) & 0x7;
+        return { reg(rs) | (immediate ? 0 : reg(rn)), reg(rd) | FLAGS_ALL, true };
+    }
+
+    // move / compare / add / subtract immediate
+    if ((opcode & 0xE000) == 0x2000)
+    {
+        const auto rd8 = (opcode >> 8) & 0x7;
+
+        switch ((opcode >> 11) & 0x3)
+        {
+            case 0: return { 0, reg(rd8) | FLAGS_NZ, true }; // mov
+            case 1: return { reg(rd8), FLAGS_ALL, true }; // cmp
+            default: return { reg(rd8), reg(rd8) | FLAGS_ALL, true }; // add, sub
+        }
+    }
+
+    // alu operations
+    if ((opcode & 0xFC00) == 0x4000)
+    {
+        switch ((opcode >> 6) & 0xF)
+        {
+            case 0x0: case 0xC: case 0xE: // and, orr, bic
+            case 0x1: // eor
+                return { reg(rd) | reg(rs), reg(rd) | FLAGS_NZ, true };
+            // shift by register, carry isn't changed if the amount is 0
+            case 0x2: case 0x3: case 0x4: case 0x7: // lsl, lsr, asr, ror
+                return { reg(rd) | reg(rs) | FLAG_C, reg(rd) | FLAGS_NZ | FLAG_C, true };
+            case 0x5: case 0x6: // adc, sbc
+                return { reg(rd) | reg(rs) | FLAG_C, reg(rd) | FLAGS_ALL, true };
+            case 0x8: // tst
+                return { reg(rd) | reg(rs), FLAGS_NZ, true };
+            case 0x9: // neg
+                return { reg(rs), reg(rd) | FLAGS_ALL, true };
+            case 0xA: case 0xB: // cmp, cmn
+                return { reg(rd) | reg(rs), FLAGS_ALL, true };
+            case 0xF: // mvn
+                return { reg(rs), reg(rd) | FLAGS_NZ, true };
+            default: // mul
+                return { 0, 0, false };
+        }
+    }
+
+    // hi register operations / bx
+    if ((opcode & 0xFC00) == 0x4400)
+    {
+        const auto hi_rd = rd | ((opcode >> 4) & 0x8);
+        const auto hi_rs = (opcode >> 3) & 0xF;
+
+        switch ((opcode >> 8) & 0x3)
+        {
+            case 0: return { reg(hi_rd) | reg(hi_rs), reg(hi_rd), hi_rd != PC_INDEX }; // add
+            case 1: return { reg(hi_rd) | reg(hi_rs), FLAGS_ALL, true }; // cmp
+            case 2: return { reg(hi_rs), reg(hi_rd), hi_rd != PC_INDEX }; // mov
+            default: return { 0, 0, false }; // bx
+        }
+    }
+
+    // pc relative load
+    if ((opcode & 0xF800) == 0x4800)
+    {
+        return { 0, reg((opcode >> 8) & 0x7), true };
+    }
+
+    // load / store with register offset and sign extended byte / halfword
+    if ((opcode & 0xF000) == 0x5000)
+    {
+        const auto ro = (opcode >> 6) & 0x7;
+        const auto sign_extended = opcode & 0x200;
+        const auto load = sign_extended ? (opcode & 0xC00) != 0 : (opcode & 0x800) != 0;
+        return { reg(rs) | reg(ro), reg(rd), load };
+    }
+
+    // load / store with immediate offset, load / store halfword
+    if ((opcode & 0xE000) == 0x6000 || (opcode & 0xF000) == 0x8000)
+    {
+        return { reg(rs), reg(rd), (opcode & 0x800) != 0 };
+    }
+
+    // sp relative load / store
+    if ((opcode & 0xF000) == 0x9000)
+    {
+        return { reg(SP_INDEX), reg((opcode >> 8) & 0x7), (opcode & 0x800) != 0 };
+    }
+
+    // load address
+    if ((opcode & 0xF000) == 0xA000)
+    {
+        return { (opcode & 0x800) ? reg(SP_INDEX) : 0, reg((opcode >> 8) & 0x7), true };
+    }
+
+    // add offset to sp
+    if ((opcode & 0xFF00) == 0xB000)
+    {
+        return { reg(SP_INDEX), reg(SP_INDEX), true };
+    }
+
+    // conditional branch, but not swi / undefined
+    if ((opcode & 0xF000) == 0xD000 && (opcode & 0x0F00) < 0x0E00)
+    {
+        const auto offset = bit::sign_extend<8>((opcode & 0xFF) << 1);
+        const auto target = addr + 4 + offset;
+        const auto exits = target < loop_start || target > loop_end;
+        return { get_cond_flags(opcode >> 8), 0, exits };
+    }
+
+    // push / pop, ldm / stm, swi, b, bl
+    return { 0, 0, false };
+}
+
+[[nodiscard]]
+auto get_usage_arm(const u32 opcode, const u32 addr, const u32 loop_start, const u32 loop_end) -> Usage
+{
+    const auto cond = opcode >> 28;
+    const auto rd = (opcode >> 12) & 0xF;
+    const auto rn = (opcode >> 16) & 0xF;
+    const auto rm = opcode & 0xF;
+
+    if (cond == 0xF)
+    {
+        return { 0, 0, false };
+    }
+
+    Usage usage{ 0, 0, false };
+
+    // multiply, swap, halfword transfers
+    if ((opcode & 0x0E000090) == 0x00000090)
+    {
+        const auto sh = (opcode >> 5) & 0x3;
+        const auto load = opcode & (1 << 20);
+        const auto pre_index = opcode & (1 << 24);
+        const auto write_back = opcode & (1 << 21);
+        const auto immediate = opcode & (1 << 22);
+
+        if (sh != 0 && load && pre_index && !write_back && rd != PC_INDEX)
+        {
+            usage = { reg(rn) | (immediate ? 0 : reg(rm)), reg(rd), true };
+        }
+    }
+    // data processing, but not mrs / msr / bx or shift by register
+    else if ((opcode & 0x0C000000) == 0x00000000 && (opcode & 0x01900000) != 0x01000000 && ((opcode & 0x02000010) != 0x00000010))
+    {
+        const auto immediate = opcode & (1 << 25);
+        const auto set_flags = opcode & (1 << 20);
+        const auto op = (opcode >> 21) & 0xF;
+        const auto logical = op <= 1 || (op >= 8 && op <= 9) || op >= 12;
+        const auto test = op >= 8 && op <= 11;
+        const auto move = op == 13 || op == 15;
+
+        usage.ok = rd != PC_INDEX || test;
+        usage.reads = (move ? 0 : reg(rn)) | (immediate ? 0 : reg(rm));
+        usage.writes = test ? 0 : reg(rd);
+
+        const auto shift_type = (opcode >> 5) & 0x3;
+        const auto shift_amount = (opcode >> 7) & 0x1F;
+        const auto rrx = !immediate && shift_type == 3 && shift_amount == 0;
+        const auto shifter_carry = immediate ? (opcode & 0xF00) != 0 : !(shift_type == 0 && shift_amount == 0);
+
+        if (rrx || op == 5 || op == 6 || op == 7) // rrx, adc, sbc, rsc
+        {
+            usage.reads |= FLAG_C;
+        }
+
+        if (set_flags)
+        {
+            usage.writes |= logical ? FLAGS_NZ | (shifter_carry ? FLAG_C : 0) : FLAGS_ALL;
+        }
+    }
+    // single data transfer
+    else if ((opcode & 0x0C000000) == 0x04000000)
+    {
+        const auto register_offset = opcode & (1 << 25);
+        const auto load = opcode & (1 << 20);
+        const auto pre_index = opcode & (1 << 24);
+        const auto write_back = opcode & (1 << 21);
+
+        // undefined
+        if (register_offset && (opcode & 0x10))
+        {
+            return { 0, 0, false };
+        }
+
+        const auto rrx = register_offset && (opcode & 0xFE0) == 0x060;
+        usage.ok = load && pre_index && !write_back && rd != PC_INDEX;
+        usage.reads = reg(rn) | (register_offset ? reg(rm) : 0) | (rrx ? FLAG_C : 0);
+        usage.writes = reg(rd);
+    }
+    // branch without link
+    else if ((opcode & 0x0F000000) == 0x0A000000)
+    {
+        const auto offset = bit::sign_extend<25>((opcode & 0xFFFFFF) << 2);
+        const auto target = addr + 8 + offset;
+        usage.ok = target < loop_start || target > loop_end;
+    }
+
+    // a conditional instruction may keep the old value
+    if (cond != COND_AL)
+    {
+        usage.reads |= get_cond_flags(cond) | usage.writes;
+    }
+
+    return usage;
+}
+
+template<typename T> [[nodiscard]]
+auto read_opcode(const u8* code, const u32 offset) -> T
+{
+    T data;
+    std::memcpy(&data, code + offset, sizeof(T));
+
+    if constexpr(std::endian::native == std::endian::big)
+    {
+        return std::byteswap(data);
+    }
+
+    return data;
+}
+
+// a loop is idle if it has no side effects, and every register (and flag)
+// that it writes to is written before it's read. so the iteration doesn't
+// depend on the last, only on what it reads from memory.
+[[nodiscard]]
+auto analyse(const Gba& gba, const Entry& entry, const u32 size) -> bool
+{
+    if (std::ranges::find(gba.idle.known_loops, entry.target) != gba.idle.known_loops.end())
+    {
+        return true;
+    }
+
+    if (size > MAX_LOOP_SIZE)
+    {
+        return false;
+    }
+
+    const auto opcode_size = entry.thumb ? 2U : 4U;
+    u32 defined = 0;
+    u32 read_before_defined = 0;
+
+    for (u32 offset = 0; offset < size; offset += opcode_size)
+    {
+        const auto addr = entry.target + offset;
+        Usage usage{};
+
+        // the branch at the end only reads the flags
+        if (addr == entry.addr)
+        {
+            const auto cond = entry.thumb ? read_opcode<u16>(entry.code, offset) >> 8 : read_opcode<u32>(entry.code, offset) >> 28;
+            const auto conditional = entry.thumb ? (read_opcode<u16>(entry.code, offset) & 0xF000) == 0xD000 : cond != COND_AL;
+            usage = { conditional ? get_cond_flags(cond) : 0, 0, true };
+        }
+        else if (entry.thumb)
+        {
+            usage = get_usage_thumb(read_opcode<u16>(entry.code, offset), addr, entry.target, entry.addr);
+        }
+        else
+        {
+            usage = get_usage_arm(read_opcode<u32>(entry.code, offset), addr, entry.target, entry.addr);
+        }
+
+        if (!usage.ok)
+        {
+            return false;
+        }
+
+        read_before_defined |= usage.reads & ~defined & ~PC_BIT;
+        defined |= usage.writes;
+    }
+
+    return (read_before_defined & defined) == 0;
+}
+
+// returns nullptr if the loop can't be read directly (ie, gpio / eeprom)
+[[nodiscard]]
+auto get_code(const Gba& gba, const u32 target, const u32 size) -> const u8*
+{
+    const auto& entry = gba.rmap[mem::get_read_page(target)];
+    const auto offset = target & entry.mask;
+
+    // the code may continue into an unmapped page (shared roms)
+    if (entry.array == nullptr || offset + size > entry.mask + 1U || gba.rmap[mem::get_read_page(target + size - 1)].array == nullptr)
+    {
+        return nullptr;
+    }
+
+    return entry.array + offset;
+}
+
+} // namespace
+
+auto on_backward_branch(Gba& gba, const u32 addr, const u32 target, const bool thumb) -> void
+{
+    if (!gba.idle_loop_skip)
+    {
+        return;
+    }
+
+    // longer loops are still cached so that they're returned early
+    // next time. they're only idle if they're known loops, in which case
+    // only the start of the loop is compared.
+    const auto size = addr - target + (thumb ? 2 : 4);
+    const auto code_size = std::min<u32>(size, MAX_LOOP_SIZE);
+
+    const auto code = get_code(gba, target, code_size);
+    if (code == nullptr)
+    {
+        return;
+    }
+
+    auto& entry = gba.idle.entries[(addr >> 1) & (CACHE_SIZE - 1)];
+    const auto hit = entry.valid && entry.addr == addr && entry.target == target && entry.thumb == thumb;
+
+    if (!hit || std::memcmp(entry.code, code, code_size))
+    {
+        entry.addr = addr;
+        entry.target = target;
+        entry.thumb = thumb;
+        std::memcpy(entry.code, code, code_size);
+        entry.idle = analyse(gba, entry, size);
+        entry.valid = true;
+    }
+
+    if (!entry.idle)
+    {
+        return;
+    }
+
+    auto& idle = gba.idle;
+    auto& scheduler = gba.scheduler;
+
+    // if an event fired during the last iteration, what was read may have
+    // already changed, so wait until an iteration has run without one.
+    if (idle.last_valid && idle.last_addr == addr && idle.last_next_event_cycles == scheduler.next_event_cycles)
+    {
+        // the event is fired once this instruction has finished
+        const auto cycles = scheduler.cycles + scheduler.elapsed;
+
+        if (scheduler.next_event_cycles > cycles)
+        {
+            scheduler.elapsed += scheduler.next_event_cycles - cycles;
+        }
+    }
+
+    idle.last_addr = addr;
+    idle.last_next_event_cycles = scheduler.next_event_cycles;
+    idle.last_valid = true;
+}
+
+auto flush(Gba& gba) -> void
+{
+    for (auto& entry : gba.idle.entries)
+    {
+        entry.valid = false;
+    }
+
+    gba.idle.last_valid = false;
+}
+
+} // namespace gba::arm7tdmi::idle
@@ -0,0 +1,75 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include "fwd.hpp"
+#include <vector>
+
+// idle loop detection.
+// lots of games wait for vblank / an irq by spinning on vcount, dispstat
+// or a flag in iwram, rather than using halt. a short loop that only
+// reads memory, and doesn't carry anything over from the last iteration,
+// does exactly the same thing every iteration until an event changes what
+// it reads. so once an iteration has run without an event firing, the
+// cpu is skipped ahead to the next event, same as a halt.
+//
+// the only difference is that the loop may exit up to one event later
+// if what it reads changes without an event (ie, timer counters).
+namespace gba::arm7tdmi::idle {
+
+enum : u32
+{
+    // loops longer than this (in bytes) are only idle if they're known
+    MAX_LOOP_SIZE = 32,
+    // number of loops in the cache, has to be power of 2
+    CACHE_SIZE = 64,
+};
+
+struct Entry
+{
+    u32 addr; // address of the branch at the end of the loop
+    u32 target; // address of the start of the loop
+    // the code (up to MAX_LOOP_SIZE) is compared on lookup, so that
+    // loops in ram are analysed again if they're overwritten.
+    u8 code[MAX_LOOP_SIZE];
+    bool thumb;
+    bool valid;
+    bool idle;
+};
+
+struct Cache
+{
+    Entry entries[CACHE_SIZE];
+
+    // the idle loop branch that was last taken, and the next event
+    // at the time. if both are the same the next time it's taken, then
+    // no event fired during the last iteration.
+    u32 last_addr;
+    u32 last_next_event_cycles;
+    bool last_valid;
+
+    // start addresses of loops that are always treated as idle,
+    // for games where the loop isn't detected (see Gba::set_idle_loops()).
+    std::vector<u32> known_loops;
+
+    // most backward branches are normal loops, this is checked
+    // before calling on_backward_branch() to return early for those.
+    [[nodiscard]] auto is_busy_loop(const u32 addr, const u32 target, const bool thumb) const -> bool
+    {
+        const auto& entry = entries[(addr >> 1) & (CACHE_SIZE - 1)];
+        return entry.valid && !entry.idle && entry.addr == addr && entry.target == target && entry.thumb == thumb;
+    }
+};
+
+// called after a branch to an earlier address has been taken.
+// addr is the address of the branch, target is where it jumped to.
+// a loop in ram that's overwritten with an idle loop isn't skipped if
+// it was a busy loop before, but an idle loop that's overwritten is
+// always caught.
+STATIC auto on_backward_branch(Gba& gba, u32 addr, u32 target, bool thumb) -> void;
+
+// clears the cache (not the known loops), called on reset and loadstate
+STATIC auto flush(Gba& gba) -> void;
+
+} // namespace gba::arm7tdmi::idle
@@ -0,0 +1,191 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "jit.hpp"
+#include "gba.hpp"
+#include "mem.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <ranges>
+
+namespace gba::arm7tdmi::jit {
+namespace {
+
+template<typename T> [[nodiscard]]
+auto read_opcode(const mem::ReadArray& entry, const u32 addr) -> T
+{
+    T data;
+    std::memcpy(&data, entry.array + (addr & entry.mask), sizeof(T));
+
+    if constexpr(std::endian::native == std::endian::big)
+    {
+        return std::byteswap(data);
+    }
+
+    return data;
+}
+
+// these don't have to be exact as the runner also checks if pc
+// changed, it's just to avoid decoding past the end of a block.
+[[nodiscard]]
+auto ends_block_thumb(const u16 opcode) -> bool
+{
+    return (opcode & 0xF000) == 0xD000 // conditional branch / swi
+        || (opcode & 0xF800) == 0xE000 // unconditional branch
+        || (opcode & 0xF800) == 0xF800 // long branch with link (2nd half)
+        || (opcode & 0xFF00) == 0x4700 // bx
+        || (opcode & 0xFC87) == 0x4487 // hi register op with rd=pc
+        || (opcode & 0xFF00) == 0xBD00; // pop {pc}
+}
+
+[[nodiscard]]
+auto ends_block_arm(const u32 opcode) -> bool
+{
+    return (opcode & 0x0E000000) == 0x0A000000 // branch
+        || (opcode & 0x0F000000) == 0x0F000000 // swi
+        || (opcode & 0x0FFFFFF0) == 0x012FFF10 // bx
+        || (opcode & 0x0E108000) == 0x08108000 // ldm with pc in rlist
+        || ((opcode & 0x0C000000) == 0x00000000 && (opcode & 0xF000) == 0xF000) // data processing rd=pc
+        || ((opcode & 0x0C000000) == 0x04000000 && (opcode & 0xF000) == 0xF000); // ldr/str rd=pc
+}
+
+// only ram and rom are cached. bios, vram and the other regions
+// fallback to the normal interpreter.
+[[nodiscard]]
+constexpr auto is_cacheable_region(const u32 region) -> bool
+{
+    return region == 0x2 || region == 0x3 || (region >= 0x8 && region <= 0xD);
+}
+
+[[nodiscard]]
+auto get_page_generation(Gba& gba, const u32 addr) -> u32&
+{
+    switch ((addr >> 24) & 0xF)
+    {
+        case 0x2: return gba.jit.ewram_generation[(addr & mem::EWRAM_MASK) >> PAGE_SHIFT];
+        case 0x3: return gba.jit.iwram_generation[(addr & mem::IWRAM_MASK) >> PAGE_SHIFT];
+        default: return gba.jit.rom_generation;
+    }
+}
+
+auto set_page(Gba& gba, const u32 addr, const bool value) -> void
+{
+    switch ((addr >> 24) & 0xF)
+    {
+        case 0x2: gba.jit.ewram_pages[(addr & mem::EWRAM_MASK) >> PAGE_SHIFT] = value; break;
+        case 0x3: gba.jit.iwram_pages[(addr & mem::IWRAM_MASK) >> PAGE_SHIFT] = value; break;
+    }
+}
+
+} // namespace
+
+auto get_block(Gba& gba, const u32 pc) -> Block&
+{
+    return gba.jit.blocks[(pc >> 1) & (CACHE_SIZE - 1)];
+}
+
+auto build_block(Gba& gba, Block& block, const u32 pc, const bool thumb) -> bool
+{
+    const auto region = pc >> 24;
+    if (!is_cacheable_region(region))
+    {
+        return false;
+    }
+
+    // will be empty if the page is handled by a function (gpio, eeprom)
+    const auto& entry = gba.rmap[mem::get_read_page(pc)];
+    if (entry.array == nullptr)
+    {
+        return false;
+    }
+
+    const auto& page_generation = get_page_generation(gba, pc);
+    block.page_generation = &page_generation;
+    block.generation = page_generation;
+    block.pc = pc;
+    block.count = 0;
+    block.fetch_cycles = mem::get_access_timing(pc, thumb ? 2 : 4);
+    block.thumb = thumb;
+    block.valid = true;
+
+    const auto page = pc >> PAGE_SHIFT;
+    const auto step = thumb ? 2 : 4;
+
+    for (auto addr = pc; block.count < BLOCK_MAX_INSTRUCTIONS && (addr >> PAGE_SHIFT) == page; addr += step)
+    {
+        if (thumb)
+        {
+            const auto opcode = read_opcode<u16>(entry, addr);
+            block.instructions[block.count++].opcode = opcode;
+
+            if (ends_block_thumb(opcode))
+            {
+                break;
+            }
+        }
+        else
+        {
+            const auto opcode = read_opcode<u32>(entry, addr);
+            block.instructions[block.count++].opcode = opcode;
+
+            if (ends_block_arm(opcode))
+            {
+                break;
+            }
+        }
+    }
+
+    set_page(gba, pc, true);
+
+    return true;
+}
+
+auto invalidate(Gba& gba, const u32 addr) -> void
+{
+    // the page is marked again once a block is rebuilt from it
+    set_page(gba, addr, false);
+    get_page_generation(gba, addr)++;
+}
+
+auto flush(Gba& gba) -> void
+{
+    if (!gba.jit.blocks)
+    {
+        gba.jit.blocks = std::make_unique<Block[]>(CACHE_SIZE);
+    }
+
+    for (u32 i = 0; i < CACHE_SIZE; i++)
+    {
+        gba.jit.blocks[i].valid = false;
+    }
+
+    std::ranges::fill(gba.jit.ewram_pages, false);
+    std::ranges::fill(gba.jit.iwram_pages, false);
+    std::ranges::fill(gba.jit.ewram_generation, 0);
+    std::ranges::fill(gba.jit.iwram_generation, 0);
+    gba.jit.rom_generation = 0;
+}
+
+auto invalidate_changed(Gba& gba, const mem::Mem& mem) -> void
+{
+    for (u32 i = 0; i < std::size(gba.jit.ewram_pages); i++)
+    {
+        const auto offset = i << PAGE_SHIFT;
+        if (gba.jit.ewram_pages[i] && std::memcmp(gba.mem.ewram + offset, mem.ewram + offset, PAGE_SIZE))
+        {
+            invalidate(gba, 0x02000000 + offset);
+        }
+    }
+
+    for (u32 i = 0; i < std::size(gba.jit.iwram_pages); i++)
+    {
+        const auto offset = i << PAGE_SHIFT;
+        if (gba.jit.iwram_pages[i] && std::memcmp(gba.mem.iwram + offset, mem.iwram + offset, PAGE_SIZE))
+        {
+            invalidate(gba, 0x03000000 + offset);
+        }
+    }
+}
+
+} // namespace gba::arm7tdmi::jit
@@ -0,0 +1,109 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include "fwd.hpp"
+#include "mem.hpp"
+#include <memory>
+
+// basic block cache used by INTERPRETER_JIT.
+// blocks are decoded once and cached by pc, each entry holds the
+// already resolved handler so that the hot loop skips the decode.
+// no host code is emitted (yet), so this works everywhere.
+namespace gba::arm7tdmi::jit {
+
+enum : u32
+{
+    // blocks are split if they get longer than this
+    BLOCK_MAX_INSTRUCTIONS = 32,
+    // number of blocks in the cache, has to be power of 2
+    CACHE_SIZE = 1024 * 4,
+    // blocks never cross a page, so invalidating a page is simple
+    PAGE_SHIFT = 8,
+    PAGE_SIZE = 1 << PAGE_SHIFT,
+};
+
+using ArmFunc = void(*)(Gba& gba, u32 opcode);
+using ThumbFunc = void(*)(Gba& gba, u16 opcode);
+
+struct Instruction
+{
+    union
+    {
+        ArmFunc arm;
+        ThumbFunc thumb;
+    };
+
+    u32 opcode;
+};
+
+struct Block
+{
+    // the block is stale once this no longer matches the page generation
+    const u32* page_generation;
+    u32 generation;
+
+    u32 pc; // address of the first instruction
+    u16 count; // number of instructions in the block
+    u8 fetch_cycles; // cycles for each opcode fetch
+    bool thumb;
+    bool valid;
+
+    [[nodiscard]] auto is_stale() const -> bool
+    {
+        return generation != *page_generation;
+    }
+
+    Instruction instructions[BLOCK_MAX_INSTRUCTIONS];
+};
+
+struct Cache
+{
+    // allocated on flush(), empty for the other interpreters
+    std::unique_ptr<Block[]> blocks;
+
+    // set when a block has been built from a page in ram,
+    // writes to these pages will invalidate the blocks
+    bool ewram_pages[mem::EWRAM_SIZE >> PAGE_SHIFT];
+    bool iwram_pages[mem::IWRAM_SIZE >> PAGE_SHIFT];
+
+    // bumped on invalidate, so that all the blocks in the page
+    // become stale without having to search for them.
+    u32 ewram_generation[mem::EWRAM_SIZE >> PAGE_SHIFT];
+    u32 iwram_generation[mem::IWRAM_SIZE >> PAGE_SHIFT];
+    // rom can't be written to, so this never changes
+    u32 rom_generation;
+
+    [[nodiscard]] auto is_code(const u32 addr) const -> bool
+    {
+        switch ((addr >> 24) & 0xF)
+        {
+            case 0x2: return ewram_pages[(addr & mem::EWRAM_MASK) >> PAGE_SHIFT];
+            case 0x3: return iwram_pages[(addr & mem::IWRAM_MASK) >> PAGE_SHIFT];
+            default: return false;
+        }
+    }
+};
+
+// returns the slot for the pc, check is_hit() before using it
+STATIC auto get_block(Gba& gba, u32 pc) -> Block&;
+[[nodiscard]] inline auto is_hit(const Block& block, const u32 pc, const bool thumb) -> bool
+{
+    return block.valid && block.pc == pc && block.thumb == thumb && !block.is_stale();
+}
+
+// reads the opcodes of the block starting at pc, the caller then
+// fills in the handlers. returns false if the pc isn't in a region
+// that can be cached (bios, vram, gpio, eeprom).
+STATIC auto build_block(Gba& gba, Block& block, u32 pc, bool thumb) -> bool;
+
+// invalidates all blocks in the page of addr
+STATIC auto invalidate(Gba& gba, u32 addr) -> void;
+// invalidates every block, called on reset and loadstate
+STATIC auto flush(Gba& gba) -> void;
+// invalidates the code pages that differ from mem, called before
+// restoring a snapshot as that doesn't go through the write handlers.
+STATIC auto invalidate_changed(Gba& gba, const mem::Mem& mem) -> void;
+
+} // namespace gba::arm7tdmi::jit
@@ -58,35 +58,35 @@ auto alu_operations(Gba& gba, const u16 opcode) -> void
     }
     else if constexpr(Op == LSL)
     {
-        const auto [result, carry] = barrel::shift_reg<barrel::type::lsl>(oprand1, oprand2, CPU.cpsr.C);
+        const auto [result, carry] = barrel::shift_reg<barrel::type::lsl>(oprand1, oprand2, CPU.flags.c);
         set_logical_flags<true>(gba, result, carry);
         set_reg_thumb(gba, Rd, result);
     }
     else if constexpr(Op == LSR)
     {
-        const auto [result, carry] = barrel::shift_reg<barrel::type::lsr>(oprand1, oprand2, CPU.cpsr.C);
+        const auto [result, carry] = barrel::shift_reg<barrel::type::lsr>(oprand1, oprand2, CPU.flags.c);
         set_logical_flags<true>(gba, result, carry);
         set_reg_thumb(gba, Rd, result);
     }
     else if constexpr(Op == ASR)
     {
-        const auto [result, carry] = barrel::shift_reg<barrel::type::asr>(oprand1, oprand2, CPU.cpsr.C);
+        const auto [result, carry] = barrel::shift_reg<barrel::type::asr>(oprand1, oprand2, CPU.flags.c);
         set_logical_flags<true>(gba, result, carry);
         set_reg_thumb(gba, Rd, result);
     }
     else if constexpr(Op == ADC)
     {
-        const auto result = internal_adc<true>(gba, oprand1, oprand2, CPU.cpsr.C);
+        const auto result = internal_adc<true>(gba, oprand1, oprand2, CPU.flags.c);
         set_reg_thumb(gba, Rd, result);
     }
     else if constexpr(Op == SBC)
     {
-        const auto result = internal_sbc<true>(gba, oprand1, oprand2, !CPU.cpsr.C);
+        const auto result = internal_sbc<true>(gba, oprand1, oprand2, !CPU.flags.c);
         set_reg_thumb(gba, Rd, result);
     }
     else if constexpr(Op == ROR)
     {
-        const auto [result, carry] = barrel::shift_reg<barrel::type::ror>(oprand1, oprand2, CPU.cpsr.C);
+        const auto [result, carry] = barrel::shift_reg<barrel::type::ror>(oprand1, oprand2, CPU.flags.c);
         set_logical_flags<true>(gba, result, carry);
         set_reg_thumb(gba, Rd, result);
     }
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "arm7tdmi/arm7tdmi.hpp"
+#include "arm7tdmi/idle.hpp"
 #include "bit.hpp"
 #include "gba.hpp"
 
@@ -17,7 +18,13 @@ auto conditional_branch(Gba& gba, const u16 opcode) -> void
 
     if (check_cond(gba, cond))
     {
-        set_pc(gba, get_pc(gba) + soffest8);
+        const auto pc = get_pc(gba);
+        set_pc(gba, pc + soffest8);
+
+        if (soffest8 < 0 && !gba.idle.is_busy_loop(pc - 4, pc + soffest8, true))
+        {
+            idle::on_backward_branch(gba, pc - 4, pc + soffest8, true);
+        }
     }
 }
 
@@ -19,7 +19,7 @@ auto move_shifted_register(Gba& gba, const u16 opcode) -> void
     const auto Rd = bit::get_range<0, 2>(opcode);
     const auto value_to_be_shifted = get_reg(gba, Rs);
 
-    const auto [result, carry] = barrel::shift_imm<Op>(value_to_be_shifted, Offset5, CPU.cpsr.C);
+    const auto [result, carry] = barrel::shift_imm<Op>(value_to_be_shifted, Offset5, CPU.flags.c);
 
     set_logical_flags<true>(gba, result, carry);
     set_reg_thumb(gba, Rd, result);
@@ -0,0 +1,101 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "thumb_table.hpp"
+#include "arm7tdmi/cached.hpp"
+#include "scheduler.hpp"
+
+namespace gba::arm7tdmi::thumb {
+namespace {
+
+constexpr auto func_table = generate_function_table();
+
+// returns false if the frame ended or we exit thumb
+inline auto dispatch(Gba& gba) -> bool
+{
+    gba.scheduler.cycles += gba.scheduler.elapsed;
+    gba.scheduler.elapsed = 0;
+
+    if (gba.scheduler.next_event_cycles <= gba.scheduler.cycles)
+    {
+        scheduler::fire(gba);
+
+        if (gba.scheduler.frame_end) [[unlikely]]
+        {
+            return false;
+        }
+    }
+
+    return CPU.cpsr.T;
+}
+
+// same as fetch() but the opcode is read from the cache if it's there.
+// returns the handler for the opcode now in pipeline[1].
+inline auto fetch_cached(Gba& gba) -> cached::ThumbFunc
+{
+    const auto addr = CPU.registers[PC_INDEX];
+    auto* slot = gba.cached.get_slot(addr);
+
+    if (slot != nullptr && slot->state == cached::State::THUMB) [[likely]]
+    {
+        gba.scheduler.tick(slot->cycles);
+        CPU.pipeline[1] = slot->opcode;
+        return slot->thumb;
+    }
+
+    const auto opcode = mem::read16(gba, addr);
+    const auto func = func_table[opcode >> 6];
+    CPU.pipeline[1] = opcode;
+
+    // gpio and eeprom are handled by functions so they can't be cached
+    if (slot != nullptr && gba.rmap[mem::get_read_page(addr)].array != nullptr)
+    {
+        slot->thumb = func;
+        slot->opcode = opcode;
+        slot->cycles = mem::get_access_timing(addr, 2);
+        slot->state = cached::State::THUMB;
+    }
+
+    return func;
+}
+
+struct Decoded
+{
+    cached::ThumbFunc func;
+    u32 opcode;
+};
+
+} // namespace
+
+// only returns on frame end or when the cpu switches to arm.
+auto execute(Gba& gba) -> void
+{
+    // handlers of the opcodes in the pipeline, these are checked against
+    // the pipeline before use as it may have been refilled (branch, irq).
+    Decoded decoded[2] =
+    {
+        { func_table[CPU.pipeline[0] >> 6], CPU.pipeline[0] },
+        { func_table[CPU.pipeline[1] >> 6], CPU.pipeline[1] },
+    };
+
+    for (;;)
+    {
+        const u16 opcode = CPU.pipeline[0];
+        const auto func = decoded[0].opcode == opcode ? decoded[0].func : func_table[opcode >> 6];
+
+        CPU.pipeline[0] = CPU.pipeline[1];
+        CPU.registers[PC_INDEX] += 2;
+        decoded[0] = decoded[1];
+        decoded[1].func = fetch_cached(gba);
+        decoded[1].opcode = CPU.pipeline[1];
+
+        func(gba, opcode);
+
+        if (!dispatch(gba))
+        {
+            return;
+        }
+    }
+}
+
+} // namespace gba::arm7tdmi::thumb
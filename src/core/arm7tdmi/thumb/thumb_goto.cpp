@@ -41,7 +41,7 @@ inline auto fetch(Gba& gba) -> u16
     const u16 opcode = CPU.pipeline[0];
     CPU.pipeline[0] = CPU.pipeline[1];
     gba.cpu.registers[PC_INDEX] += 2;
-    CPU.pipeline[1] = mem::read16(gba, get_pc(gba));
+    CPU.pipeline[1] = mem::read_code16(gba, get_pc(gba));
 
     return opcode;
 }
@@ -1072,17 +1072,40 @@ inline auto fetch(Gba& gba) -> u16
     const u16 opcode = CPU.pipeline[0];
     CPU.pipeline[0] = CPU.pipeline[1];
     gba.cpu.registers[PC_INDEX] += 2;
-    CPU.pipeline[1] = mem::read16(gba, get_pc(gba));
+    CPU.pipeline[1] = mem::read_code16(gba, get_pc(gba));
 
     return opcode;
 }
 
+// returns false if the frame ended or we exit thumb
+inline auto dispatch(Gba& gba) -> bool
+{
+    gba.scheduler.cycles += gba.scheduler.elapsed;
+    gba.scheduler.elapsed = 0;
+
+    if (gba.scheduler.next_event_cycles <= gba.scheduler.cycles)
+    {
+        scheduler::fire(gba);
+
+        if (gba.scheduler.frame_end) [[unlikely]]
+        {
+            return false;
+        }
+    }
+
+    return CPU.cpsr.T;
+}
+
 } // namespace
 
+// only returns on frame end or when the cpu switches to arm.
 auto execute(Gba& gba) -> void
 {
-    const auto opcode = fetch(gba);
-    decode_switch(gba, opcode);
+    do
+    {
+        const auto opcode = fetch(gba);
+        decode_switch(gba, opcode);
+    } while (dispatch(gba));
 }
 
 } // namespace gba::arm7tdmi::thumb
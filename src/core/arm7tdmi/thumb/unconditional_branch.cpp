@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "arm7tdmi/arm7tdmi.hpp"
+#include "arm7tdmi/idle.hpp"
 #include "bit.hpp"
 #include "gba.hpp"
 
@@ -14,7 +15,13 @@ auto unconditional_branch(Gba& gba, const u16 opcode) -> void
     auto offset11 = bit::get_range<0, 10>(opcode) << 1;
     offset11 = bit::sign_extend<11>(offset11);
 
-    set_pc(gba, get_pc(gba) + offset11);
+    const auto pc = get_pc(gba);
+    set_pc(gba, pc + offset11);
+
+    if (offset11 < 0 && !gba.idle.is_busy_loop(pc - 4, pc + offset11, true))
+    {
+        idle::on_backward_branch(gba, pc - 4, pc + offset11, true);
+    }
 }
 
 } // namespace
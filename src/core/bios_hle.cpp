@@ -6,9 +6,12 @@
 #include "bios_hle.hpp"
 #include "arm7tdmi/arm7tdmi.hpp"
 #include "mem.hpp"
+#include <bit>
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <span>
+#include <vector>
 
 namespace gba::bios {
 namespace {
@@ -89,6 +92,73 @@ constexpr const char* SWI_STR[0xFF] =
    "Crash", "Crash",
 };
 
+// the hle functions do the same memory accesses as the bios, so those
+// are timed as normal. these are rough counts of the cycles the bios
+// spends on everything else per unit of work, so that the calls still
+// take about as long as they would on hw.
+constexpr u32 ARCTAN_CYCLES = 40; // per call
+constexpr u32 FASTSET_CYCLES = 4; // per 8 words
+constexpr u32 AFFINE_CYCLES = 30; // per entry
+constexpr u32 BITUNPACK_CYCLES = 10; // per src unit
+constexpr u32 LZ77_CYCLES = 8; // per byte
+constexpr u32 HUFF_CYCLES = 8; // per bit
+constexpr u32 RL_CYCLES = 6; // per byte
+constexpr u32 DIFF_CYCLES = 5; // per unit
+
+// sin(i / 256 * 2pi) in 1.14 fixed point (truncated), same as the bios.
+// cos is sin offset by 64.
+constexpr s16 SINE_TABLE[256] =
+{
+    0x0000, 0x0192, 0x0323, 0x04B5, 0x0645, 0x07D5, 0x0964, 0x0AF1,
+    0x0C7C, 0x0E05, 0x0F8C, 0x1111, 0x1294, 0x1413, 0x158F, 0x1708,
+    0x187D, 0x19EF, 0x1B5D, 0x1CC6, 0x1E2B, 0x1F8B, 0x20E7, 0x223D,
+    0x238E, 0x24DA, 0x261F, 0x275F, 0x2899, 0x29CD, 0x2AFA, 0x2C21,
+    0x2D41, 0x2E5A, 0x2F6B, 0x3076, 0x3179, 0x3274, 0x3367, 0x3453,
+    0x3536, 0x3612, 0x36E5, 0x37AF, 0x3871, 0x392A, 0x39DA, 0x3A82,
+    0x3B20, 0x3BB6, 0x3C42, 0x3CC5, 0x3D3E, 0x3DAE, 0x3E14, 0x3E71,
+    0x3EC5, 0x3F0E, 0x3F4E, 0x3F84, 0x3FB1, 0x3FD3, 0x3FEC, 0x3FFB,
+    0x4000, 0x3FFB, 0x3FEC, 0x3FD3, 0x3FB1, 0x3F84, 0x3F4E, 0x3F0E,
+    0x3EC5, 0x3E71, 0x3E14, 0x3DAE, 0x3D3E, 0x3CC5, 0x3C42, 0x3BB6,
+    0x3B20, 0x3A82, 0x39DA, 0x392A, 0x3871, 0x37AF, 0x36E5, 0x3612,
+    0x3536, 0x3453, 0x3367, 0x3274, 0x3179, 0x3076, 0x2F6B, 0x2E5A,
+    0x2D41, 0x2C21, 0x2AFA, 0x29CD, 0x2899, 0x275F, 0x261F, 0x24DA,
+    0x238E, 0x223D, 0x20E7, 0x1F8B, 0x1E2B, 0x1CC6, 0x1B5D, 0x19EF,
+    0x187D, 0x1708, 0x158F, 0x1413, 0x1294, 0x1111, 0x0F8C, 0x0E05,
+    0x0C7C, 0x0AF1, 0x0964, 0x07D5, 0x0645, 0x04B5, 0x0323, 0x0192,
+    0x0000, -0x0192, -0x0323, -0x04B5, -0x0645, -0x07D5, -0x0964, -0x0AF1,
+    -0x0C7C, -0x0E05, -0x0F8C, -0x1111, -0x1294, -0x1413, -0x158F, -0x1708,
+    -0x187D, -0x19EF, -0x1B5D, -0x1CC6, -0x1E2B, -0x1F8B, -0x20E7, -0x223D,
+    -0x238E, -0x24DA, -0x261F, -0x275F, -0x2899, -0x29CD, -0x2AFA, -0x2C21,
+    -0x2D41, -0x2E5A, -0x2F6B, -0x3076, -0x3179, -0x3274, -0x3367, -0x3453,
+    -0x3536, -0x3612, -0x36E5, -0x37AF, -0x3871, -0x392A, -0x39DA, -0x3A82,
+    -0x3B20, -0x3BB6, -0x3C42, -0x3CC5, -0x3D3E, -0x3DAE, -0x3E14, -0x3E71,
+    -0x3EC5, -0x3F0E, -0x3F4E, -0x3F84, -0x3FB1, -0x3FD3, -0x3FEC, -0x3FFB,
+    -0x4000, -0x3FFB, -0x3FEC, -0x3FD3, -0x3FB1, -0x3F84, -0x3F4E, -0x3F0E,
+    -0x3EC5, -0x3E71, -0x3E14, -0x3DAE, -0x3D3E, -0x3CC5, -0x3C42, -0x3BB6,
+    -0x3B20, -0x3A82, -0x39DA, -0x392A, -0x3871, -0x37AF, -0x36E5, -0x3612,
+    -0x3536, -0x3453, -0x3367, -0x3274, -0x3179, -0x3076, -0x2F6B, -0x2E5A,
+    -0x2D41, -0x2C21, -0x2AFA, -0x29CD, -0x2899, -0x275F, -0x261F, -0x24DA,
+    -0x238E, -0x223D, -0x20E7, -0x1F8B, -0x1E2B, -0x1CC6, -0x1B5D, -0x19EF,
+    -0x187D, -0x1708, -0x158F, -0x1413, -0x1294, -0x1111, -0x0F8C, -0x0E05,
+    -0x0C7C, -0x0AF1, -0x0964, -0x07D5, -0x0645, -0x04B5, -0x0323, -0x0192,
+};
+
+// BIOS_IF, the irq handler sets the bits of the irqs it handled here
+constexpr u32 BIOS_IF = 0x03007FF8;
+
+// the bios ignores (or rather, doesn't allow) reading from itself,
+// so let it handle those.
+[[nodiscard]] auto is_bios_addr(const u32 addr) -> bool
+{
+    return (addr & 0x0E000000) == 0;
+}
+
+// the bios does everything in 32bit, so wrap the same way it does
+[[nodiscard]] auto mul32(const s32 a, const s32 b) -> s32
+{
+    return static_cast<s32>(static_cast<u32>(a) * static_cast<u32>(b));
+}
+
 // https://problemkaputt.de/gbatek.htm#biosarithmeticfunctions
 
 // 0x2
@@ -98,12 +168,62 @@ auto Halt(Gba& gba) -> bool
     return true;
 }
 
-// 0x6
-auto Div(Gba& gba) -> bool
+// https://problemkaputt.de/gbatek.htm#bioshaltfunctions
+auto intr_wait(Gba& gba, const bool discard, const u16 flags) -> bool
+{
+    // this would never return, let the bios deal with it
+    if (!REG_IE || CPU.cpsr.I)
+    {
+        return false;
+    }
+
+    // only discard the old flags on the first call, not after an irq
+    if (discard && !CPU.intr_wait)
+    {
+        mem::write16(gba, BIOS_IF, mem::read16(gba, BIOS_IF) & ~flags);
+    }
+
+    mem::write16(gba, mem::IO_IME, 1);
+
+    if (const u16 bios_if = mem::read16(gba, BIOS_IF); bios_if & flags)
+    {
+        mem::write16(gba, BIOS_IF, bios_if & ~flags);
+        CPU.intr_wait = false;
+        return true;
+    }
+
+    // rewind to the swi so that it's called again when
+    // the irq handler returns, until one of the flags is set.
+    const auto thumb = arm7tdmi::get_state(gba) == arm7tdmi::State::THUMB;
+    arm7tdmi::set_pc(gba, arm7tdmi::get_pc(gba) - (thumb ? 4 : 8));
+    CPU.intr_wait = true;
+
+    // halt would exit straight away if an irq is already pending
+    if (!(REG_IE & REG_IF & 0x3FFF))
+    {
+        arm7tdmi::on_halt_trigger(gba, arm7tdmi::HaltType::hle_intr_wait);
+    }
+
+    return true;
+}
+
+// 0x4
+auto IntrWait(Gba& gba) -> bool
+{
+    return intr_wait(gba, arm7tdmi::get_reg(gba, 0) & 1, arm7tdmi::get_reg(gba, 1));
+}
+
+// 0x5
+auto VBlankIntrWait(Gba& gba) -> bool
 {
-    const s32 number = arm7tdmi::get_reg(gba, 0);
-    const s32 denom = arm7tdmi::get_reg(gba, 1);
+    // the bios sets r0 and r1 to 1 and falls through to IntrWait
+    arm7tdmi::set_reg(gba, 0, 1);
+    arm7tdmi::set_reg(gba, 1, 1);
+    return intr_wait(gba, true, 1);
+}
 
+auto div(Gba& gba, const s32 number, const s32 denom) -> bool
+{
     if (number == 0 || denom == 0)
     {
         return false; // don't handle edge cases
@@ -120,6 +240,19 @@ auto Div(Gba& gba) -> bool
     return true;
 }
 
+// 0x6
+auto Div(Gba& gba) -> bool
+{
+    return div(gba, arm7tdmi::get_reg(gba, 0), arm7tdmi::get_reg(gba, 1));
+}
+
+// 0x7
+auto DivArm(Gba& gba) -> bool
+{
+    // same as Div but with r0 and r1 swapped
+    return div(gba, arm7tdmi::get_reg(gba, 1), arm7tdmi::get_reg(gba, 0));
+}
+
 // 0x8
 auto Sqrt(Gba& gba) -> bool
 {
@@ -129,6 +262,88 @@ auto Sqrt(Gba& gba) -> bool
     return true;
 }
 
+// tan is 1.14 fixed point, returns -pi/2 to pi/2 as 0xC000 to 0x4000.
+// the bios approximates it with a polynomial in 1.14 fixed point.
+auto arctan(const s32 tan) -> s32
+{
+    const auto a = -(mul32(tan, tan) >> 14);
+    auto b = (mul32(0xA9, a) >> 14) + 0x390;
+    b = (mul32(b, a) >> 14) + 0x91C;
+    b = (mul32(b, a) >> 14) + 0xFB6;
+    b = (mul32(b, a) >> 14) + 0x16AA;
+    b = (mul32(b, a) >> 14) + 0x2081;
+    b = (mul32(b, a) >> 14) + 0x3651;
+    b = (mul32(b, a) >> 14) + 0xA2F9;
+    return mul32(tan, b) >> 16;
+}
+
+// returns y / x in 1.14 fixed point, x is never 0
+auto arctan2_div(const s32 y, const s32 x) -> s32
+{
+    const auto number = static_cast<s32>(static_cast<u32>(y) << 14);
+    return x == -1 ? mul32(number, -1) : number / x;
+}
+
+// returns 0 to 2pi as 0x0000 to 0xFFFF.
+// arctan only works for -1 <= tan <= 1, so the angle is
+// found from whichever of y/x or x/y is in that range.
+auto arctan2(const s32 x, const s32 y) -> u16
+{
+    if (y == 0)
+    {
+        return x >= 0 ? 0x0000 : 0x8000;
+    }
+
+    if (x == 0)
+    {
+        return y >= 0 ? 0x4000 : 0xC000;
+    }
+
+    if (y >= 0)
+    {
+        if (x >= 0 && x >= y)
+        {
+            return arctan(arctan2_div(y, x));
+        }
+        if (x < 0 && -x >= y)
+        {
+            return arctan(arctan2_div(y, x)) + 0x8000;
+        }
+        return 0x4000 - arctan(arctan2_div(x, y));
+    }
+    else
+    {
+        if (x <= 0 && -x > -y)
+        {
+            return arctan(arctan2_div(y, x)) + 0x8000;
+        }
+        if (x > 0 && x >= -y)
+        {
+            return arctan(arctan2_div(y, x)) + 0x10000;
+        }
+        return 0xC000 - arctan(arctan2_div(x, y));
+    }
+}
+
+// 0x9
+auto ArcTan(Gba& gba) -> bool
+{
+    const s32 tan = arm7tdmi::get_reg(gba, 0);
+    arm7tdmi::set_reg(gba, 0, arctan(tan));
+    gba.scheduler.tick(ARCTAN_CYCLES);
+    return true;
+}
+
+// 0xA
+auto ArcTan2(Gba& gba) -> bool
+{
+    const s32 x = static_cast<s16>(arm7tdmi::get_reg(gba, 0));
+    const s32 y = static_cast<s16>(arm7tdmi::get_reg(gba, 1));
+    arm7tdmi::set_reg(gba, 0, arctan2(x, y));
+    gba.scheduler.tick(ARCTAN_CYCLES);
+    return true;
+}
+
 // 0xB
 auto CpuSet(Gba& gba) -> bool
 {
@@ -187,6 +402,455 @@ auto CpuSet(Gba& gba) -> bool
     return true;
 }
 
+// 0xC
+auto CpuFastSet(Gba& gba) -> bool
+{
+    auto src = mem::align<u32>(arm7tdmi::get_reg(gba, 0));
+    auto dst = mem::align<u32>(arm7tdmi::get_reg(gba, 1));
+    const auto r2 = arm7tdmi::get_reg(gba, 2);
+
+    if (is_bios_addr(src))
+    {
+        return false;
+    }
+
+    // always 32bit, 8 words at a time (ldm / stm), so the
+    // len is rounded up to a multiple of 8.
+    const auto len = (bit::get_range<0, 20>(r2) + 7) & ~7;
+    const auto mode = bit::is_set<24>(r2);
+
+    if (mode == 0) // copy
+    {
+        for (u32 i = 0; i < len; i++, src += 4, dst += 4)
+        {
+            mem::write32(gba, dst, mem::read32(gba, src));
+        }
+    }
+    else // fill
+    {
+        const auto data = mem::read32(gba, src);
+        src += 4;
+
+        for (u32 i = 0; i < len; i++, dst += 4)
+        {
+            mem::write32(gba, dst, data);
+        }
+    }
+
+    gba.scheduler.tick(len / 8 * FASTSET_CYCLES);
+
+    // same as CpuSet
+    arm7tdmi::set_reg_thumb(gba, 0, src);
+    arm7tdmi::set_reg_thumb(gba, 1, dst);
+    arm7tdmi::set_reg_thumb(gba, 2, r2 & ~0b11111111111111111111);
+
+    return true;
+}
+
+// https://problemkaputt.de/gbatek.htm#biosrotationscalingfunctions
+struct Affine
+{
+    s32 pa, pb, pc, pd;
+};
+
+// scale is 8.8 fixed point, only the upper 8 bits of the angle are used
+auto get_affine(const s32 sx, const s32 sy, const u16 angle) -> Affine
+{
+    const s32 sin = SINE_TABLE[angle >> 8];
+    const s32 cos = SINE_TABLE[((angle >> 8) + 64) & 0xFF];
+
+    return
+    {
+        .pa = (sx * cos) >> 14,
+        .pb = -((sx * sin) >> 14),
+        .pc = (sy * sin) >> 14,
+        .pd = (sy * cos) >> 14,
+    };
+}
+
+// 0xE
+auto BgAffineSet(Gba& gba) -> bool
+{
+    auto src = arm7tdmi::get_reg(gba, 0);
+    auto dst = arm7tdmi::get_reg(gba, 1);
+    const auto count = arm7tdmi::get_reg(gba, 2);
+
+    for (u32 i = 0; i < count; i++, src += 20, dst += 16)
+    {
+        // original center (19.8), display center, scale (8.8), angle
+        const s32 ox = mem::read32(gba, src + 0);
+        const s32 oy = mem::read32(gba, src + 4);
+        const s16 cx = mem::read16(gba, src + 8);
+        const s16 cy = mem::read16(gba, src + 10);
+        const s16 sx = mem::read16(gba, src + 12);
+        const s16 sy = mem::read16(gba, src + 14);
+        const u16 angle = mem::read16(gba, src + 16);
+
+        const auto [pa, pb, pc, pd] = get_affine(sx, sy, angle);
+
+        // start is the original center minus the rotated display center
+        const auto x = ox - (pa * cx + pb * cy);
+        const auto y = oy - (pc * cx + pd * cy);
+
+        mem::write16(gba, dst + 0, pa);
+        mem::write16(gba, dst + 2, pb);
+        mem::write16(gba, dst + 4, pc);
+        mem::write16(gba, dst + 6, pd);
+        mem::write32(gba, dst + 8, x);
+        mem::write32(gba, dst + 12, y);
+    }
+
+    gba.scheduler.tick(count * AFFINE_CYCLES);
+    return true;
+}
+
+// 0xF
+auto ObjAffineSet(Gba& gba) -> bool
+{
+    auto src = arm7tdmi::get_reg(gba, 0);
+    auto dst = arm7tdmi::get_reg(gba, 1);
+    const auto count = arm7tdmi::get_reg(gba, 2);
+    // 2 for writing to a struct, 8 for writing to oam
+    const auto stride = arm7tdmi::get_reg(gba, 3);
+
+    for (u32 i = 0; i < count; i++, src += 8, dst += stride * 4)
+    {
+        const s16 sx = mem::read16(gba, src + 0);
+        const s16 sy = mem::read16(gba, src + 2);
+        const u16 angle = mem::read16(gba, src + 4);
+
+        const auto [pa, pb, pc, pd] = get_affine(sx, sy, angle);
+
+        mem::write16(gba, dst + stride * 0, pa);
+        mem::write16(gba, dst + stride * 1, pb);
+        mem::write16(gba, dst + stride * 2, pc);
+        mem::write16(gba, dst + stride * 3, pd);
+    }
+
+    gba.scheduler.tick(count * AFFINE_CYCLES);
+    return true;
+}
+
+// https://problemkaputt.de/gbatek.htm#biosdecompressionfunctions
+
+// 0x10
+auto BitUnPack(Gba& gba) -> bool
+{
+    auto src = arm7tdmi::get_reg(gba, 0);
+    auto dst = mem::align<u32>(arm7tdmi::get_reg(gba, 1));
+    const auto info = arm7tdmi::get_reg(gba, 2);
+
+    if (is_bios_addr(src))
+    {
+        return false;
+    }
+
+    const u16 len = mem::read16(gba, info + 0);
+    const u8 src_width = mem::read8(gba, info + 2);
+    const u8 dst_width = mem::read8(gba, info + 3);
+    const u32 offset = mem::read32(gba, info + 4);
+    const auto data_offset = bit::get_range<0, 30>(offset);
+    const auto zero_flag = bit::is_set<31>(offset);
+
+    // only 1,2,4,8 -> 1,2,4,8,16,32 are supported
+    if (!std::has_single_bit(src_width) || src_width > 8 || !std::has_single_bit(dst_width) || dst_width > 32)
+    {
+        return false;
+    }
+
+    const u32 src_mask = (1 << src_width) - 1;
+    u32 out = 0;
+    u32 out_bits = 0;
+
+    for (u32 i = 0; i < len; i++)
+    {
+        const u8 data = mem::read8(gba, src++);
+
+        for (u32 bit = 0; bit < 8; bit += src_width)
+        {
+            auto unit = (data >> bit) & src_mask;
+
+            if (unit || zero_flag)
+            {
+                unit += data_offset;
+            }
+
+            out |= unit << out_bits;
+            out_bits += dst_width;
+
+            if (out_bits == 32)
+            {
+                mem::write32(gba, dst, out);
+                dst += 4;
+                out = 0;
+                out_bits = 0;
+            }
+        }
+    }
+
+    gba.scheduler.tick(len * (8 / src_width) * BITUNPACK_CYCLES);
+    return true;
+}
+
+// the header before the compressed data
+struct Header
+{
+    u8 data_size; // in bits
+    u8 type;
+    u32 size; // size of the decompressed data
+};
+
+auto read_header(Gba& gba, u32& src) -> Header
+{
+    const auto header = mem::read32(gba, src);
+    src += 4;
+
+    return
+    {
+        .data_size = static_cast<u8>(bit::get_range<0, 3>(header)),
+        .type = static_cast<u8>(bit::get_range<4, 7>(header)),
+        .size = bit::get_range<8, 31>(header),
+    };
+}
+
+// the data is decompressed into a buffer first and then written out.
+// the Write8bit versions are for wram, the Write16bit versions for vram
+// (which can't be written a byte at a time), these drop the last byte
+// if the size is odd.
+auto write_out(Gba& gba, const u32 dst, std::span<const u8> data, const bool write16) -> void
+{
+    if (write16)
+    {
+        for (std::size_t i = 0; i + 1 < data.size(); i += 2)
+        {
+            mem::write16(gba, dst + i, data[i] | (data[i + 1] << 8));
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < data.size(); i++)
+        {
+            mem::write8(gba, dst + i, data[i]);
+        }
+    }
+}
+
+// 0x11, 0x12
+auto LZ77UnComp(Gba& gba, const bool write16) -> bool
+{
+    auto src = arm7tdmi::get_reg(gba, 0);
+    const auto dst = arm7tdmi::get_reg(gba, 1);
+
+    if (is_bios_addr(src))
+    {
+        return false;
+    }
+
+    const auto header = read_header(gba, src);
+    std::vector<u8> out(header.size);
+
+    for (u32 i = 0; i < header.size;)
+    {
+        // each bit (msb first) says if the next block is
+        // a literal byte (0) or a copy of earlier data (1).
+        const u8 flags = mem::read8(gba, src++);
+
+        for (u32 bit = 0x80; bit && i < header.size; bit >>= 1)
+        {
+            if (flags & bit)
+            {
+                const u8 a = mem::read8(gba, src++);
+                const u8 b = mem::read8(gba, src++);
+                const u32 disp = (((a & 0xF) << 8) | b) + 1;
+                const u32 end = std::min<u32>(i + (a >> 4) + 3, header.size);
+
+                for (; i < end; i++)
+                {
+                    // the bios reads the data back from dst, so this can
+                    // (in theory) copy from before the start of dst.
+                    // when writing 16bit, the previous byte hasn't been
+                    // written yet if it's the low byte, so the old value is read.
+                    const auto stale = write16 && disp == 1 && (i & 1);
+                    out[i] = i >= disp && !stale ? out[i - disp] : mem::read8(gba, dst + i - disp);
+                }
+            }
+            else
+            {
+                out[i++] = mem::read8(gba, src++);
+            }
+        }
+    }
+
+    write_out(gba, dst, out, write16);
+    gba.scheduler.tick(header.size * LZ77_CYCLES);
+    return true;
+}
+
+// 0x13
+auto HuffUnComp(Gba& gba) -> bool
+{
+    auto src = arm7tdmi::get_reg(gba, 0);
+    auto dst = mem::align<u32>(arm7tdmi::get_reg(gba, 1));
+
+    if (is_bios_addr(src))
+    {
+        return false;
+    }
+
+    const auto header = read_header(gba, src);
+
+    // only 4 and 8 bit data are supported
+    if (header.data_size != 4 && header.data_size != 8)
+    {
+        return false;
+    }
+
+    // the tree size is followed by the tree, which starts with the root.
+    // the bitstream starts after the tree, in units of 32bits.
+    const auto tree_size = mem::read8(gba, src);
+    const auto root = src + 1;
+    auto bitstream = src + (tree_size + 1) * 2;
+
+    auto node_addr = root;
+    u8 node = mem::read8(gba, node_addr);
+    u32 out = 0;
+    u32 out_bits = 0;
+    u32 written = 0;
+    u32 bits_read = 0;
+
+    while (written < header.size)
+    {
+        const auto bits = mem::read32(gba, bitstream);
+        bitstream += 4;
+
+        // msb first, 0 = node0, 1 = node1
+        for (u32 bit = 1U << 31; bit && written < header.size; bit >>= 1, bits_read++)
+        {
+            const auto node1 = (bits & bit) != 0;
+            const auto child = (node_addr & ~1) + bit::get_range<0, 5>(node) * 2 + 2 + node1;
+            const auto is_data = bit::is_set(node, node1 ? 6 : 7);
+
+            node_addr = is_data ? root : child;
+            const u8 value = mem::read8(gba, child);
+            node = is_data ? mem::read8(gba, root) : value;
+
+            if (is_data)
+            {
+                out |= value << out_bits;
+                out_bits += header.data_size;
+
+                if (out_bits == 32)
+                {
+                    mem::write32(gba, dst, out);
+                    dst += 4;
+                    written += 4;
+                    out = 0;
+                    out_bits = 0;
+                }
+            }
+        }
+    }
+
+    gba.scheduler.tick(bits_read * HUFF_CYCLES);
+    return true;
+}
+
+// 0x14, 0x15
+auto RLUnComp(Gba& gba, const bool write16) -> bool
+{
+    auto src = arm7tdmi::get_reg(gba, 0);
+    const auto dst = arm7tdmi::get_reg(gba, 1);
+
+    if (is_bios_addr(src))
+    {
+        return false;
+    }
+
+    const auto header = read_header(gba, src);
+    std::vector<u8> out(header.size);
+
+    for (u32 i = 0; i < header.size;)
+    {
+        // bit7 set is a run of the same byte, otherwise uncompressed
+        const u8 flag = mem::read8(gba, src++);
+
+        if (flag & 0x80)
+        {
+            const u8 data = mem::read8(gba, src++);
+            const u32 end = std::min<u32>(i + (flag & 0x7F) + 3, header.size);
+
+            for (; i < end; i++)
+            {
+                out[i] = data;
+            }
+        }
+        else
+        {
+            const u32 end = std::min<u32>(i + (flag & 0x7F) + 1, header.size);
+
+            for (; i < end; i++)
+            {
+                out[i] = mem::read8(gba, src++);
+            }
+        }
+    }
+
+    write_out(gba, dst, out, write16);
+    gba.scheduler.tick(header.size * RL_CYCLES);
+    return true;
+}
+
+// 0x16, 0x17
+auto Diff8bitUnFilter(Gba& gba, const bool write16) -> bool
+{
+    auto src = arm7tdmi::get_reg(gba, 0);
+    const auto dst = arm7tdmi::get_reg(gba, 1);
+
+    if (is_bios_addr(src))
+    {
+        return false;
+    }
+
+    const auto header = read_header(gba, src);
+    std::vector<u8> out(header.size);
+    u8 data = 0;
+
+    // each unit is the difference from the last
+    for (u32 i = 0; i < header.size; i++)
+    {
+        data += mem::read8(gba, src++);
+        out[i] = data;
+    }
+
+    write_out(gba, dst, out, write16);
+    gba.scheduler.tick(header.size * DIFF_CYCLES);
+    return true;
+}
+
+// 0x18
+auto Diff16bitUnFilter(Gba& gba) -> bool
+{
+    auto src = arm7tdmi::get_reg(gba, 0);
+    const auto dst = arm7tdmi::get_reg(gba, 1);
+
+    if (is_bios_addr(src))
+    {
+        return false;
+    }
+
+    const auto header = read_header(gba, src);
+    u16 data = 0;
+
+    for (u32 i = 0; i + 1 < header.size; i += 2, src += 2)
+    {
+        data += mem::read16(gba, src);
+        mem::write16(gba, dst + i, data);
+    }
+
+    gba.scheduler.tick(header.size / 2 * DIFF_CYCLES);
+    return true;
+}
+
 } // namespace
 
 auto hle(Gba& gba, u8 comment_field) -> bool
@@ -197,9 +861,26 @@ auto hle(Gba& gba, u8 comment_field) -> bool
     switch (comment_field)
     {
         case 0x02: return Halt(gba);
+        case 0x04: return IntrWait(gba);
+        case 0x05: return VBlankIntrWait(gba);
         case 0x06: return Div(gba);
+        case 0x07: return DivArm(gba);
         case 0x08: return Sqrt(gba);
+        case 0x09: return ArcTan(gba);
+        case 0x0A: return ArcTan2(gba);
         case 0x0B: return CpuSet(gba);
+        case 0x0C: return CpuFastSet(gba);
+        case 0x0E: return BgAffineSet(gba);
+        case 0x0F: return ObjAffineSet(gba);
+        case 0x10: return BitUnPack(gba);
+        case 0x11: return LZ77UnComp(gba, false);
+        case 0x12: return LZ77UnComp(gba, true);
+        case 0x13: return HuffUnComp(gba);
+        case 0x14: return RLUnComp(gba, false);
+        case 0x15: return RLUnComp(gba, true);
+        case 0x16: return Diff8bitUnFilter(gba, false);
+        case 0x17: return Diff8bitUnFilter(gba, true);
+        case 0x18: return Diff16bitUnFilter(gba);
 
         default:
             // std::printf("[BIOS-HLE] unhandled: 0x%02X %s\n", comment_field, SWI_STR[comment_field]);
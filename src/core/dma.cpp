@@ -64,6 +64,33 @@ auto get_channel_registers(Gba& gba, const u8 channel_num) -> Registers
     std::unreachable();
 }
 
+// transfers between plain memory (rom / ram to vram, pram, oam or ram)
+// are done in one go, as nothing can observe the transfer mid-way.
+// returns false for everything else (io, fifo, eeprom, decrementing).
+auto bulk_transfer(Gba& gba, Channel& dma, const u8 channel_num) -> bool
+{
+    const u8 size = dma.size_type == SizeType::half ? sizeof(u16) : sizeof(u32);
+
+    if (dma.dst_increment <= 0 || (dma.src_increment != 0 && dma.src_increment != size))
+    {
+        return false;
+    }
+
+    const auto src = (dma.src_addr & ~(size - 1)) & SRC_MASK[channel_num];
+    const auto dst = (dma.dst_addr & ~(size - 1)) & DST_MASK[channel_num];
+
+    if (!mem::bulk_copy(gba, dst, src, dma.len, size, dma.src_increment == 0))
+    {
+        return false;
+    }
+
+    dma.src_addr = src + dma.len * dma.src_increment;
+    dma.dst_addr = dst + dma.len * dma.dst_increment;
+    dma.len = 0;
+
+    return true;
+}
+
 template<bool Special = false>
 auto start_dma(Gba& gba, Channel& dma, const u8 channel_num) -> void
 {
@@ -110,41 +137,45 @@ auto start_dma(Gba& gba, Channel& dma, const u8 channel_num) -> void
             }
         }
 
-        switch (dma.size_type)
+        // plain memory transfers (the common case) are done in one go
+        if (!bulk_transfer(gba, dma, channel_num))
         {
-            case SizeType::half:
-                dma.src_addr = mem::align<u16>(dma.src_addr);
-                dma.dst_addr = mem::align<u16>(dma.dst_addr);
-
-                while (dma.len--)
-                {
-                    dma.src_addr &= SRC_MASK[channel_num];
-                    dma.dst_addr &= DST_MASK[channel_num];
-
-                    const auto value = mem::read16(gba, dma.src_addr);
-                    mem::write16(gba, dma.dst_addr, value);
-
-                    dma.src_addr += dma.src_increment;
-                    dma.dst_addr += dma.dst_increment;
-                }
-                break;
-
-            case SizeType::word:
-                dma.src_addr = mem::align<u32>(dma.src_addr);
-                dma.dst_addr = mem::align<u32>(dma.dst_addr);
-
-                while (dma.len--)
-                {
-                    dma.src_addr &= SRC_MASK[channel_num];
-                    dma.dst_addr &= DST_MASK[channel_num];
-
-                    const auto value = mem::read32(gba, dma.src_addr);
-                    mem::write32(gba, dma.dst_addr, value);
-
-                    dma.src_addr += dma.src_increment;
-                    dma.dst_addr += dma.dst_increment;
-                }
-                break;
+            switch (dma.size_type)
+            {
+                case SizeType::half:
+                    dma.src_addr = mem::align<u16>(dma.src_addr);
+                    dma.dst_addr = mem::align<u16>(dma.dst_addr);
+
+                    while (dma.len--)
+                    {
+                        dma.src_addr &= SRC_MASK[channel_num];
+                        dma.dst_addr &= DST_MASK[channel_num];
+
+                        const auto value = mem::read16(gba, dma.src_addr);
+                        mem::write16(gba, dma.dst_addr, value);
+
+                        dma.src_addr += dma.src_increment;
+                        dma.dst_addr += dma.dst_increment;
+                    }
+                    break;
+
+                case SizeType::word:
+                    dma.src_addr = mem::align<u32>(dma.src_addr);
+                    dma.dst_addr = mem::align<u32>(dma.dst_addr);
+
+                    while (dma.len--)
+                    {
+                        dma.src_addr &= SRC_MASK[channel_num];
+                        dma.dst_addr &= DST_MASK[channel_num];
+
+                        const auto value = mem::read32(gba, dma.src_addr);
+                        mem::write32(gba, dma.dst_addr, value);
+
+                        dma.src_addr += dma.src_increment;
+                        dma.dst_addr += dma.dst_increment;
+                    }
+                    break;
+            }
         }
     }
 
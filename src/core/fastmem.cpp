@@ -0,0 +1,208 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "fastmem.hpp"
+#include "gba.hpp"
+#include "mem.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <ranges>
+
+#if FASTMEM
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+namespace gba::fastmem {
+namespace {
+
+#if FASTMEM
+// maps size bytes of the shared memory at offset to every mirror
+// in [start, end) of the guest address space.
+auto map_mirrors(Gba& gba, const u32 start, const u32 end, const u32 offset, const u32 size) -> bool
+{
+    for (auto addr = start; addr < end; addr += size)
+    {
+        auto ptr = mmap(gba.fastmem.base + addr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, gba.fastmem.fd, offset);
+
+        if (ptr == MAP_FAILED)
+        {
+            std::printf("[FASTMEM] failed to map 0x%08X\n", addr);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// replaces the memory of array with the shared memory at offset,
+// the contents are kept.
+auto remap_array(Gba& gba, u8* array, const u32 offset, const u32 size) -> bool
+{
+    if (pwrite(gba.fastmem.fd, array, size, offset) != static_cast<ssize_t>(size))
+    {
+        return false;
+    }
+
+    return mmap(array, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, gba.fastmem.fd, offset) != MAP_FAILED;
+}
+
+// gives the array its own memory again, the contents are lost
+auto restore_array(u8* array, const u32 size) -> void
+{
+    mmap(array, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+}
+
+auto unmap_all(Fastmem& fastmem) -> void
+{
+    if (fastmem.ewram)
+    {
+        restore_array(fastmem.ewram, mem::EWRAM_SIZE);
+        fastmem.ewram = nullptr;
+    }
+
+    if (fastmem.iwram)
+    {
+        restore_array(fastmem.iwram, mem::IWRAM_SIZE);
+        fastmem.iwram = nullptr;
+    }
+
+    if (fastmem.base)
+    {
+        munmap(fastmem.base, ADDRESS_SPACE_SIZE);
+        fastmem.base = nullptr;
+    }
+
+    if (fastmem.fd != -1)
+    {
+        ::close(fastmem.fd);
+        fastmem.fd = -1;
+    }
+
+    std::ranges::fill(fastmem.mapped, false);
+}
+#endif // FASTMEM
+
+} // namespace
+
+Fastmem::~Fastmem()
+{
+#if FASTMEM
+    unmap_all(*this);
+#endif
+}
+
+auto init(Gba& gba) -> bool
+{
+#if FASTMEM
+    auto& fastmem = gba.fastmem;
+
+    if (fastmem.base)
+    {
+        return true;
+    }
+
+    // iwram is the smallest mirror, and the arrays in mem have to
+    // start on a page, which they do for 4k pages (see mem::Mem).
+    const auto page_size = sysconf(_SC_PAGESIZE);
+    if (page_size <= 0 || mem::IWRAM_SIZE % page_size || reinterpret_cast<std::uintptr_t>(gba.mem.ewram) % page_size)
+    {
+        std::printf("[FASTMEM] unsupported page size: %ld\n", page_size);
+        return false;
+    }
+
+    fastmem.fd = memfd_create("notorious_beeg", MFD_CLOEXEC);
+    if (fastmem.fd == -1 || ftruncate(fastmem.fd, SHARED_SIZE))
+    {
+        std::printf("[FASTMEM] failed to create shared memory\n");
+        unmap_all(fastmem);
+        return false;
+    }
+
+    auto base = mmap(nullptr, ADDRESS_SPACE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED)
+    {
+        std::printf("[FASTMEM] failed to reserve address space\n");
+        unmap_all(fastmem);
+        return false;
+    }
+
+    fastmem.base = static_cast<u8*>(base);
+
+    const auto mapped =
+        map_mirrors(gba, 0x02000000, 0x03000000, SHARED_EWRAM_OFFSET, mem::EWRAM_SIZE) &&
+        map_mirrors(gba, 0x03000000, 0x04000000, SHARED_IWRAM_OFFSET, mem::IWRAM_SIZE) &&
+        map_mirrors(gba, 0x08000000, 0x0E000000, SHARED_ROM_OFFSET, mem::ROM_SIZE);
+
+    if (!mapped)
+    {
+        unmap_all(fastmem);
+        return false;
+    }
+
+    if (!remap_array(gba, gba.mem.ewram, SHARED_EWRAM_OFFSET, mem::EWRAM_SIZE))
+    {
+        std::printf("[FASTMEM] failed to remap ewram\n");
+        unmap_all(fastmem);
+        return false;
+    }
+
+    fastmem.ewram = gba.mem.ewram;
+
+    if (!remap_array(gba, gba.mem.iwram, SHARED_IWRAM_OFFSET, mem::IWRAM_SIZE))
+    {
+        std::printf("[FASTMEM] failed to remap iwram\n");
+        unmap_all(fastmem);
+        return false;
+    }
+
+    fastmem.iwram = gba.mem.iwram;
+
+    return true;
+#else
+    (void)gba;
+    return false;
+#endif
+}
+
+auto get_rom_storage(Gba& gba) -> std::span<u8>
+{
+    if (!gba.fastmem.base)
+    {
+        return {};
+    }
+
+    return {gba.fastmem.base + 0x08000000, mem::ROM_SIZE};
+}
+
+auto update(Gba& gba) -> void
+{
+    if (!gba.fastmem.base)
+    {
+        return;
+    }
+
+    for (u32 page = 0; page < mem::READ_PAGE_COUNT; page++)
+    {
+        update_page(gba, page << mem::READ_PAGE_SHIFT);
+    }
+}
+
+auto update_page(Gba& gba, const u32 addr) -> void
+{
+    if (!gba.fastmem.base)
+    {
+        return;
+    }
+
+    // only pages backed by the same memory as the guest offset, which
+    // rules out shared roms as they're not in the shared memory.
+    const auto page = mem::get_read_page(addr);
+    const auto array = gba.rmap[page].array;
+    const auto rom = gba.fastmem.base + 0x08000000;
+
+    gba.fastmem.mapped[page] = array != nullptr && (array == gba.mem.ewram || array == gba.mem.iwram || array == rom);
+}
+
+} // namespace gba::fastmem
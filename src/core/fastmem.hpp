@@ -0,0 +1,70 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include "fwd.hpp"
+#include "mem.hpp"
+#include <span>
+
+// fastmem (linux only, built with FASTMEM).
+// the whole 256mb guest address space is reserved on the host, and
+// ewram, iwram and the rom are mapped (along with their mirrors) at
+// their guest offsets, so a read is just base + addr.
+//
+// everything else (io, pram, vram, oam, bios, gpio, backup) is left
+// unmapped and still goes through the tables in mem.cpp. pram and oam
+// are 1kb so can't be mirrored with pages anyway.
+//
+// ewram and iwram in gba.mem are remapped to the same shared memory,
+// so both views are always the same and nothing else needs to know.
+namespace gba::fastmem {
+
+enum : u32
+{
+    // offsets into the shared memory
+    SHARED_EWRAM_OFFSET = 0,
+    SHARED_IWRAM_OFFSET = SHARED_EWRAM_OFFSET + mem::EWRAM_SIZE,
+    SHARED_ROM_OFFSET = 0x100000,
+    SHARED_SIZE = SHARED_ROM_OFFSET + mem::ROM_SIZE,
+
+    ADDRESS_SPACE_SIZE = 0x10000000,
+};
+
+struct Fastmem
+{
+    Fastmem() = default;
+    // unmaps everything and gives gba.mem its own memory back
+    ~Fastmem();
+
+    Fastmem(const Fastmem&) = delete;
+    auto operator=(const Fastmem&) -> Fastmem& = delete;
+
+    // reserved guest address space, nullptr if fastmem isn't used
+    u8* base{};
+    int fd{-1};
+
+    // the gba.mem arrays that were remapped
+    u8* ewram{};
+    u8* iwram{};
+
+    // read pages (see mem::ReadPage) that can be read from base
+    bool mapped[mem::READ_PAGE_COUNT]{};
+};
+
+// sets up fastmem if it hasn't been already, this is called on
+// loadrom. returns false if it's not supported / failed, in which
+// case the tables are used for everything.
+STATIC auto init(Gba& gba) -> bool;
+
+// returns the 32mb rom storage that's mapped at 0x08000000, or an
+// empty span if fastmem isn't used.
+[[nodiscard]]
+STATIC auto get_rom_storage(Gba& gba) -> std::span<u8>;
+
+// updates which pages can be read directly, must be called after
+// rmap changes (setup_tables(), gpio).
+STATIC auto update(Gba& gba) -> void;
+STATIC auto update_page(Gba& gba, u32 addr) -> void;
+
+} // namespace gba::fastmem
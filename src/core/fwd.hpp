@@ -14,11 +14,22 @@
 #ifndef INTERPRETER_GOTO
     #define INTERPRETER_GOTO 2
 #endif // INTERPRETER_GOTO
+#ifndef INTERPRETER_JIT
+    #define INTERPRETER_JIT 3
+#endif // INTERPRETER_JIT
+#ifndef INTERPRETER_CACHED
+    #define INTERPRETER_CACHED 4
+#endif // INTERPRETER_CACHED
 
 #ifndef INTERPRETER
     #define INTERPRETER INTERPRETER_TABLE
 #endif
 
+// see fastmem.hpp
+#ifndef FASTMEM
+    #define FASTMEM 0
+#endif
+
 #ifdef EMSCRIPTEN
 #include <ranges>
 
@@ -8,6 +8,7 @@
 #include "backup/flash.hpp"
 #include "mem.hpp"
 #include "scheduler.hpp"
+#include "state.hpp"
 #include "bios.hpp"
 
 #include <algorithm>
@@ -26,13 +27,78 @@ namespace {
 // > for optimising, offset=rom_size, otherwise fill the entire rom
 constexpr auto fill_rom_oob_values(std::span<u8> rom, const u32 offset)
 {
-    for (auto i = offset; i < rom.size(); i += 2)
+    // align down so the values match the address for odd sized roms,
+    // the rom is copied over the top afterwards.
+    for (auto i = offset & ~1; i < rom.size(); i += 2)
     {
         rom[i + 0] = i >> 1; // lower nibble (addr >> 1)
         rom[i + 1] = i >> 9; // upper nibble (addr >> (8 + 1))
     }
 }
 
+// validates the header and sets up the backup type
+auto setup_rom(Gba& gba, std::span<const u8> new_rom) -> bool
+{
+    if (new_rom.size() > mem::ROM_SIZE)
+    {
+        assert(!"rom is way too beeg");
+        return false;
+    }
+
+    const Header header{new_rom};
+
+    if (!header.validate_all())
+    {
+        assert(!"rom failed to validate rom header!");
+        return false;
+    }
+
+    // todo: handle if the user has already set / loaded sram for the game
+    // or maybe it should always be like this, load game, then load backup
+    const auto backup_type = backup::find_type(new_rom);
+    gba.backup.type = backup_type;
+    using enum backup::Type;
+
+    switch (gba.backup.type)
+    {
+        case NONE:
+            break;
+
+        case EEPROM:
+            gba.backup.eeprom.init(gba);
+            break;
+
+        case SRAM:
+            gba.backup.sram.init(gba);
+            break;
+
+        case FLASH: [[fallthrough]]; // these are aliases for each other
+        case FLASH512:
+            gba.backup.flash.init(gba, backup::flash::Type::Flash64);
+            break;
+
+        case FLASH1M:
+            gba.backup.flash.init(gba, backup::flash::Type::Flash128);
+            break;
+    }
+
+    return true;
+}
+
+// rebuilds everything that isn't saved in the state
+auto on_loadstate(Gba& gba) -> void
+{
+    mem::setup_tables(gba);
+    scheduler::on_loadstate(gba);
+    arm7tdmi::idle::flush(gba);
+
+#if INTERPRETER == INTERPRETER_JIT
+    arm7tdmi::jit::flush(gba);
+#elif INTERPRETER == INTERPRETER_CACHED
+    arm7tdmi::cached::flush(gba);
+#endif
+}
+
 } // namespace
 
 Header::Header(std::span<const u8> rom)
@@ -98,58 +164,62 @@ auto Gba::reset() -> void
     apu::reset(*this, skip_bios);
     gpio::reset(*this, skip_bios);
     arm7tdmi::reset(*this, skip_bios);
+    arm7tdmi::idle::flush(*this);
+
+#if INTERPRETER == INTERPRETER_JIT
+    arm7tdmi::jit::flush(*this);
+#elif INTERPRETER == INTERPRETER_CACHED
+    arm7tdmi::cached::flush(*this);
+#endif
 }
 
 auto Gba::loadrom(std::span<const u8> new_rom) -> bool
 {
-    if (new_rom.size() > sizeof(this->rom))
+    if (!setup_rom(*this, new_rom))
     {
-        assert(!"rom is way too beeg");
         return false;
     }
 
-    const Header header{new_rom};
+    // the rom is stored in the shared memory with fastmem, so that it's
+    // also mapped at 0x08000000 (see fastmem.hpp)
+    auto storage = fastmem::init(*this) ? fastmem::get_rom_storage(*this) : std::span<u8>{};
 
-    if (!header.validate_all())
+    if (storage.empty())
     {
-        assert(!"rom failed to validate rom header!");
-        return false;
-    }
+        // only allocate once, as it's a lot of memory
+        if (!this->rom_storage)
+        {
+            this->rom_storage = std::make_unique_for_overwrite<u8[]>(mem::ROM_SIZE);
+        }
 
-    // todo: handle if the user has already set / loaded sram for the game
-    // or maybe it should always be like this, load game, then load backup
-    const auto backup_type = backup::find_type(new_rom);
-    this->backup.type = backup_type;
-    using enum backup::Type;
+        storage = {this->rom_storage.get(), mem::ROM_SIZE};
+    }
 
-    switch (this->backup.type)
-    {
-        case NONE:
-            break;
+    // pre-calc the OOB rom read values, which is addr >> 1
+    fill_rom_oob_values(storage, new_rom.size());
 
-        case EEPROM:
-            this->backup.eeprom.init(*this);
-            break;
+    std::ranges::copy(new_rom, storage.begin());
 
-        case SRAM:
-            this->backup.sram.init(*this);
-            break;
+    this->rom = storage;
+    this->idle.known_loops.clear();
+    this->reset();
 
-        case FLASH: [[fallthrough]]; // these are aliases for each other
-        case FLASH512:
-            this->backup.flash.init(*this, backup::flash::Type::Flash64);
-            break;
+    return true;
+}
 
-        case FLASH1M:
-            this->backup.flash.init(*this, backup::flash::Type::Flash128);
-            break;
+auto Gba::loadrom_shared(std::span<const u8> shared_rom) -> bool
+{
+    if (!setup_rom(*this, shared_rom))
+    {
+        return false;
     }
 
-    // pre-calc the OOB rom read values, which is addr >> 1
-    fill_rom_oob_values(this->rom, new_rom.size());
-
-    std::ranges::copy(new_rom, this->rom);
+    // no longer needed, free it
+    this->rom_storage.reset();
 
+    // OOB reads are handled by mem instead, so no need to fill
+    this->rom = shared_rom;
+    this->idle.known_loops.clear();
     this->reset();
 
     return true;
@@ -171,6 +241,12 @@ auto Gba::loadbios(std::span<const u8> new_bios) -> bool
     return true;
 }
 
+auto Gba::set_idle_loops(std::span<const u32> addrs) -> void
+{
+    this->idle.known_loops.assign(addrs.begin(), addrs.end());
+    arm7tdmi::idle::flush(*this);
+}
+
 auto Gba::setkeys(u16 buttons, bool down) -> void
 {
     auto& gba = *this;
@@ -225,6 +301,11 @@ auto Gba::set_audio_callback(AudioCallback cb, std::span<s16> data, u32 sample_r
     }
 }
 
+auto Gba::set_pixels(void* pixels, u32 stride, PixelFormat format) -> void
+{
+    ppu::set_output(*this, pixels, stride, format);
+}
+
 auto Gba::get_render_mode() -> u8
 {
     return ppu::get_mode(*this);
@@ -270,8 +351,19 @@ auto Gba::loadstate(const State& state) -> bool
     this->backup = state.backup;
     this->gpio = state.gpio;
 
-    mem::setup_tables(*this);
-    scheduler::on_loadstate(*this);
+    on_loadstate(*this);
+
+    return true;
+}
+
+auto Gba::loadstate(std::span<const u8> data) -> bool
+{
+    if (!state::load(*this, data))
+    {
+        return false;
+    }
+
+    on_loadstate(*this);
 
     return true;
 }
@@ -302,6 +394,49 @@ auto Gba::savestate(State& state) const -> bool
     return true;
 }
 
+auto Gba::savestate(std::vector<u8>& data) const -> void
+{
+    state::save(*this, data);
+}
+
+auto Gba::snapshot(Snapshot& snapshot) const -> void
+{
+    snapshot.scheduler = this->scheduler;
+    snapshot.cpu = this->cpu;
+    snapshot.mem = this->mem;
+    std::memcpy(snapshot.ppu, &this->ppu, sizeof(snapshot.ppu));
+    snapshot.apu = this->apu;
+    std::ranges::copy(this->dma, snapshot.dma);
+    std::ranges::copy(this->timer, snapshot.timer);
+    snapshot.backup = this->backup;
+    snapshot.gpio = this->gpio;
+}
+
+auto Gba::restore(const Snapshot& snapshot) -> void
+{
+    // has to be done before mem is overwritten
+#if INTERPRETER == INTERPRETER_JIT
+    arm7tdmi::jit::invalidate_changed(*this, snapshot.mem);
+#elif INTERPRETER == INTERPRETER_CACHED
+    arm7tdmi::cached::invalidate_changed(*this, snapshot.mem);
+#endif
+
+    // the scheduler callbacks are from this instance, so they're valid
+    this->scheduler = snapshot.scheduler;
+    this->cpu = snapshot.cpu;
+    this->mem = snapshot.mem;
+    std::memcpy(&this->ppu, snapshot.ppu, sizeof(snapshot.ppu));
+    this->apu = snapshot.apu;
+    std::ranges::copy(snapshot.dma, this->dma);
+    std::ranges::copy(snapshot.timer, this->timer);
+    this->backup = snapshot.backup;
+    this->gpio = snapshot.gpio;
+
+    // gpio can map / unmap the rom
+    mem::setup_tables(*this);
+    arm7tdmi::idle::flush(*this);
+}
+
 auto Gba::loadsave(std::span<const u8> new_save) -> bool
 {
     using enum backup::Type;
@@ -362,30 +497,11 @@ auto Gba::run(u32 _cycles) -> void
         arm7tdmi::on_halt_event(*this);
     }
 
-#if INTERPRETER == INTERPRETER_GOTO
+    // every interpreter only returns on frame end or a change of state
     while (!this->scheduler.frame_end) [[likely]]
     {
         arm7tdmi::run(*this);
     }
-#else
-    for (;;)
-    {
-        arm7tdmi::run(*this);
-
-        this->scheduler.cycles += this->scheduler.elapsed;
-        this->scheduler.elapsed = 0;
-
-        if (this->scheduler.next_event_cycles <= this->scheduler.cycles)
-        {
-            scheduler::fire(*this);
-
-            if (this->scheduler.frame_end) [[unlikely]]
-            {
-                break;
-            }
-        }
-    }
-#endif // INTERPRETER_GOTO
 }
 
 } // namespace gba
@@ -4,6 +4,9 @@
 #pragma once
 
 #include "arm7tdmi/arm7tdmi.hpp"
+#include "arm7tdmi/cached.hpp"
+#include "arm7tdmi/idle.hpp"
+#include "arm7tdmi/jit.hpp"
 #include "ppu/ppu.hpp"
 #include "apu/apu.hpp"
 #include "mem.hpp"
@@ -12,9 +15,13 @@
 #include "scheduler.hpp"
 #include "backup/backup.hpp"
 #include "gpio.hpp"
+#include "fastmem.hpp"
 #include "fwd.hpp"
+#include <cstddef>
+#include <memory>
 #include <span>
 #include <string_view>
+#include <vector>
 
 namespace gba {
 
@@ -40,7 +47,10 @@ enum Button : u16
     ALL = A | B | SELECT | START | RIGHT | LEFT | UP | DOWN | R | L,
 };
 
+using ppu::PixelFormat;
+
 struct State;
+struct Snapshot;
 struct Header;
 
 using AudioCallback = void(*)(void* user);
@@ -50,34 +60,66 @@ using HblankCallback = void(*)(void* user, u16 line);
 struct Gba
 {
     // at the top so no offset needed into struct on r/w access
-    mem::ReadArray rmap[16];
+    mem::ReadArray rmap[mem::READ_PAGE_COUNT]; // see mem::ReadPage
     mem::WriteArray wmap[16];
+    mem::CodePage code_page;
 
     scheduler::Scheduler scheduler;
     arm7tdmi::Arm7tdmi cpu;
     mem::Mem mem;
     ppu::Ppu ppu;
+    ppu::ObjLines obj_lines;
+    ppu::TileCache tile_cache;
+    // see set_pixels()
+    ppu::Output frame_output;
     apu::Apu apu;
     dma::Channel dma[4];
     timer::Timer timer[4];
     backup::Backup backup;
     gpio::Gpio gpio;
+    // only used by INTERPRETER_JIT
+    arm7tdmi::jit::Cache jit;
+    // only used by INTERPRETER_CACHED
+    arm7tdmi::cached::Cache cached;
+    arm7tdmi::idle::Cache idle;
 
     // 16kb, 32-bus
     u8 bios[1024 * 16];
-    // 32mb(max), 16-bus
-    u8 rom[0x2000000];
+    // 32mb(max), 16-bus. points to either rom_storage (32mb with the
+    // OOB values filled in) or the rom passed to loadrom_shared().
+    std::span<const u8> rom;
+    // only allocated if the rom was loaded with loadrom()
+    std::unique_ptr<u8[]> rom_storage;
+    // only used when built with FASTMEM. this is after mem so that
+    // it's destroyed first, as it remaps some of mem.
+    fastmem::Fastmem fastmem;
 
     bool has_bios;
 
     auto reset() -> void;
     [[nodiscard]] auto loadrom(std::span<const u8> new_rom) -> bool;
+    // same as loadrom() but the rom isn't copied, so it can be shared
+    // (read-only) between many instances, eg a mmap'd file.
+    // the rom must outlive the instance (or until another rom is loaded).
+    [[nodiscard]] auto loadrom_shared(std::span<const u8> shared_rom) -> bool;
     [[nodiscard]] auto loadbios(std::span<const u8> new_bios) -> bool;
     auto run(u32 cycles = 280896) -> void;
 
     [[nodiscard]] auto loadstate(const State& state) -> bool;
     [[nodiscard]] auto savestate(State& state) const -> bool;
 
+    // compact chunked format (see state.hpp), this is what should be
+    // used for saving to disk. the state is appended to data.
+    [[nodiscard]] auto loadstate(std::span<const u8> data) -> bool;
+    auto savestate(std::vector<u8>& data) const -> void;
+
+    // fast in-place copy of the state, used for run-ahead.
+    // nothing is validated or rebuilt, so a snapshot can only be restored
+    // into the same instance with the same game loaded.
+    // the framebuffer and rom aren't copied.
+    auto snapshot(Snapshot& snapshot) const -> void;
+    auto restore(const Snapshot& snapshot) -> void;
+
     // load a save from data, must be used after a game has loaded
     [[nodiscard]] auto loadsave(std::span<const u8> new_save) -> bool;
     // checks if the save has been written to.
@@ -95,12 +137,38 @@ struct Gba
     auto set_vblank_callback(VblankCallback cb) { this->vblank_callback = cb; }
     auto set_hblank_callback(HblankCallback cb) { this->hblank_callback = cb; }
 
+    // each line is also written to pixels as it's rendered, converted to
+    // format. stride is the number of bytes between lines, and pixels has
+    // to stay valid until this is called again (nullptr to stop).
+    // ppu.pixels is always written to as well.
+    auto set_pixels(void* pixels, u32 stride, PixelFormat format) -> void;
+
     [[nodiscard]] auto get_render_mode() -> u8;
     // returns the priority of the layer
     [[nodiscard]] auto render_mode(std::span<u16> pixels, u8 mode, u8 layer) -> u8;
 
     bool bit_crushing{false};
 
+    // skips ahead to the next event when the game is spinning in a
+    // loop, waiting for vcount / an irq etc (see arm7tdmi/idle.hpp).
+    bool idle_loop_skip{true};
+
+    // start addresses of loops that are always skipped, for games where
+    // the idle loop isn't detected. call this after loading the rom.
+    auto set_idle_loops(std::span<const u32> addrs) -> void;
+
+    // when false, lines aren't rendered and the vblank callback isn't
+    // called. everything else (timing, dispstat, dma, irqs) is the same,
+    // so the game runs exactly as it would, only the pixels are stale.
+    bool render_enabled{true};
+    // number of frames left to not render, same as above.
+    // this is counted down on vblank.
+    u32 skip_frame_count{};
+
+    // skips rendering the next count frames, ie for fast-forward.
+    // adds to any frames already being skipped.
+    auto skip_frames(u32 count) { this->skip_frame_count += count; }
+
     void* userdata{};
     std::span<s16> sample_data;
     std::size_t sample_count;
@@ -129,6 +197,20 @@ struct State
     gpio::Gpio gpio;
 };
 
+struct Snapshot
+{
+    scheduler::Scheduler scheduler;
+    arm7tdmi::Arm7tdmi cpu;
+    mem::Mem mem;
+    // everything but the framebuffer
+    u8 ppu[offsetof(ppu::Ppu, pixels)];
+    apu::Apu apu;
+    dma::Channel dma[4];
+    timer::Timer timer[4];
+    backup::Backup backup;
+    gpio::Gpio gpio;
+};
+
 enum StateMeta : u32
 {
     MAGIC = 0xFACADE,
@@ -6,6 +6,7 @@
 #include "arm7tdmi/arm7tdmi.hpp"
 #include "backup/backup.hpp"
 #include "bit.hpp"
+#include "fastmem.hpp"
 #include "gba.hpp"
 #include "ppu/ppu.hpp"
 #include "scheduler.hpp"
@@ -810,13 +811,58 @@ auto write_oam_region(Gba& gba, const u32 addr, const T value) -> void
     if constexpr(!std::is_same<T, u8>())
     {
         write_array<T>(MEM.oam, OAM_MASK, addr, value);
+        gba.obj_lines.dirty = true;
     }
 }
 
+// used when the rom array isn't mapped, which is the case for shared
+// roms that don't fill the whole 16mb half of the region.
+// OOB reads return the lower 16-bits of the address >> 1.
+template<typename T> [[nodiscard]]
+auto read_rom(Gba& gba, u32 addr) -> T
+{
+    addr = align<T>(addr) & ROM_MASK;
+
+    if (addr + sizeof(T) <= gba.rom.size()) [[likely]]
+    {
+        return read_array<T>(gba.rom.data(), ROM_MASK, addr);
+    }
+
+    T value{};
+
+    for (u32 i = 0; i < sizeof(T); i++)
+    {
+        const auto offset = addr + i;
+        const u8 byte = offset < gba.rom.size() ? gba.rom[offset] : (offset & 1) ? (offset >> 9) : (offset >> 1);
+        value |= static_cast<T>(byte) << (8 * i);
+    }
+
+    return value;
+}
+
+// the array can only be used if the rom fully backs the page at addr
+// (0x9, 0xB, 0xD are the upper 16mb), else read_rom() is used.
+[[nodiscard]]
+auto get_rom_page(const Gba& gba, const u32 addr) -> ReadArray
+{
+    const std::size_t end = (addr & ROM_MASK) + READ_PAGE_SIZE;
+
+    if (gba.rom.size() >= end)
+    {
+        return {gba.rom.data(), ROM_MASK, Access_ALL};
+    }
+
+    return {};
+}
+
 template<typename T>
 auto read_gpio(Gba& gba, const u32 addr) -> T
 {
-    assert(gba.gpio.rw && "this handler should only be called when gpio is rw");
+    // also called for shared roms that aren't mapped
+    if (!gba.gpio.rw)
+    {
+        return read_rom<T>(gba, addr);
+    }
 
     switch (addr)
     {
@@ -830,7 +876,7 @@ auto read_gpio(Gba& gba, const u32 addr) -> T
             return gba.gpio.rw;
 
         default:
-            return read_array<T>(gba.rom, ROM_MASK, addr);
+            return read_rom<T>(gba, addr);
     }
 }
 
@@ -861,18 +907,21 @@ auto write_gpio(Gba& gba, const u32 addr, const T value)
             std::printf("[GPIO] control: %s\n", gba.gpio.rw ? "rw" : "w only");
             if (gba.gpio.rw)
             {
-                // for speed, unmap the rom from [0x8]
-                // this will cause the function ptr handler to be called instead
+                // unmap the page with gpio, this will cause the function
+                // ptr handler to be called instead for that page only
                 // which will handle the reads to gpio and rom
-                gba.rmap[0x8] = {};
+                gba.rmap[get_read_page(GPIO_DATA)] = {};
             }
             else
             {
                 // gpio is now write only
                 // remap rom array for faster reads
                 std::printf("unammped rom handler\n");
-                gba.rmap[0x8] = {gba.rom, ROM_MASK, Access_ALL};
+                gba.rmap[get_read_page(GPIO_DATA)] = get_rom_page(gba, GPIO_DATA);
             }
+
+            fastmem::update_page(gba, GPIO_DATA);
+            gba.code_page = {};
             break;
     }
 }
@@ -927,6 +976,9 @@ auto write_vram_region(Gba& gba, u32 addr, const T value) -> void
     {
         write_array<T>(MEM.vram, VRAM_MASK, addr, value);
     }
+
+    // aligned writes can't cross a tile
+    gba.tile_cache.dirty[addr / ppu::TileCache::TILE_SIZE] = true;
 }
 
 template<typename T>
@@ -964,7 +1016,7 @@ auto read_eeprom_region(Gba& gba, const u32 addr) -> T
     }
     else
     {
-        return read_array<T>(gba.rom, ROM_MASK, addr);
+        return read_rom<T>(gba, addr);
     }
 }
 
@@ -1075,11 +1127,11 @@ inline auto read_internal(Gba& gba, u32 addr) -> T
         /*[0x5] =*/ openbus, // read_pram_region<T>,
         /*[0x6] =*/ read_vram_region,
         /*[0x7] =*/ openbus, // read_oam_region<T>,
-        /*[0x8] =*/ read_gpio, // called when gpio is rw (w only default)
-        /*[0x9] =*/ openbus, // todo: add this
-        /*[0xA] =*/ openbus, // todo: add this
-        /*[0xB] =*/ openbus, // todo: add this
-        /*[0xC] =*/ openbus, // todo: add this
+        /*[0x8] =*/ read_gpio, // called when gpio is rw (w only default) or rom isn't mapped
+        /*[0x9] =*/ read_rom<T>,
+        /*[0xA] =*/ read_rom<T>,
+        /*[0xB] =*/ read_rom<T>,
+        /*[0xC] =*/ read_rom<T>,
         /*[0xD] =*/ read_eeprom_region<T>,
         /*[0xE] =*/ read_sram_region<T>,
         /*[0xF] =*/ openbus,
@@ -1088,7 +1140,15 @@ inline auto read_internal(Gba& gba, u32 addr) -> T
     gba.scheduler.tick(get_memory_timing(sizeof(T) >> 1, addr));
 
     addr = mirror_address(addr);
-    const auto& entry = gba.rmap[addr >> 24];
+
+    #if FASTMEM
+    if (gba.fastmem.mapped[addr >> READ_PAGE_SHIFT]) [[likely]]
+    {
+        return read_array<T>(gba.fastmem.base, 0x0FFFFFFF, addr);
+    }
+    #endif
+
+    const auto& entry = gba.rmap[addr >> READ_PAGE_SHIFT];
 
     if (entry.access & sizeof(T)) [[likely]]
     {
@@ -1100,6 +1160,45 @@ inline auto read_internal(Gba& gba, u32 addr) -> T
     }
 }
 
+// sets the code page to the memory at addr, if it's directly readable
+auto set_code_page(Gba& gba, u32 addr) -> void
+{
+    addr = mirror_address(addr);
+    const auto& entry = gba.rmap[addr >> READ_PAGE_SHIFT];
+
+    if (entry.access != Access_ALL)
+    {
+        gba.code_page = {};
+        return;
+    }
+
+    // smaller than the page if the memory is mirrored within it (iwram)
+    const auto size = std::min<u32>(READ_PAGE_SIZE, entry.mask + 1U);
+    const auto start = addr & ~(size - 1);
+
+    gba.code_page.array = entry.array + (start & entry.mask);
+    gba.code_page.start = start;
+    gba.code_page.size = size;
+    gba.code_page.cycles[0] = get_memory_timing(1, addr);
+    gba.code_page.cycles[1] = get_memory_timing(2, addr);
+}
+
+template<typename T>
+inline auto read_code(Gba& gba, const u32 addr) -> T
+{
+    const auto& page = gba.code_page;
+    const auto offset = align<T>(addr) - page.start;
+
+    if (offset < page.size) [[likely]]
+    {
+        gba.scheduler.tick(page.cycles[sizeof(T) >> 2]);
+        return read_array<T>(page.array, page.size - 1, offset);
+    }
+
+    set_code_page(gba, addr);
+    return read_internal<T>(gba, addr);
+}
+
 template<typename T>
 inline auto write_internal(Gba& gba, u32 addr, T value)
 {
@@ -1131,6 +1230,18 @@ inline auto write_internal(Gba& gba, u32 addr, T value)
     if (entry.access & sizeof(T)) // don't mark likely as vram,pram,io writes are common
     {
         write_array<T>(entry.array, entry.mask, addr, value);
+
+        #if INTERPRETER == INTERPRETER_JIT
+        if (gba.jit.is_code(addr)) [[unlikely]]
+        {
+            arm7tdmi::jit::invalidate(gba, addr);
+        }
+        #elif INTERPRETER == INTERPRETER_CACHED
+        if ((addr >> 24) == 0x3)
+        {
+            gba.cached.on_iwram_write(addr);
+        }
+        #endif
     }
     else
     {
@@ -1138,6 +1249,65 @@ inline auto write_internal(Gba& gba, u32 addr, T value)
     }
 }
 
+// returns the array backing [addr, addr + bytes) if the whole range
+// can be accessed directly with size, otherwise nullptr.
+// that's everything in the r/w maps, as well as vram below the mirror.
+template<bool Write> [[nodiscard]]
+auto get_direct_array(Gba& gba, u32 addr, const u32 bytes, const u8 size)
+{
+    using Ptr = std::conditional_t<Write, u8*, const u8*>;
+
+    addr = mirror_address(addr);
+    const auto region = addr >> 24;
+
+    if (region != mirror_address(addr + bytes - 1) >> 24)
+    {
+        return Ptr{};
+    }
+
+    if (region == 0x6)
+    {
+        const auto offset = addr & VRAM_MASK;
+        return offset + bytes <= VRAM_SIZE ? Ptr{MEM.vram + offset} : Ptr{};
+    }
+
+    const auto get_entry = [&gba](const u32 entry_addr) -> const auto&
+    {
+        if constexpr(Write)
+        {
+            return gba.wmap[entry_addr >> 24];
+        }
+        else
+        {
+            return gba.rmap[entry_addr >> READ_PAGE_SHIFT];
+        }
+    };
+
+    const auto& entry = get_entry(addr);
+    const auto offset = addr & entry.mask;
+
+    if (!(entry.access & size) || offset + bytes > entry.mask + 1U)
+    {
+        return Ptr{};
+    }
+
+    // the unmapped pages within a region are either the first (gpio),
+    // or all pages from some point to the end (shared roms), so if the
+    // last page is mapped then so is everything in between.
+    if (!(get_entry(addr + bytes - 1).access & size))
+    {
+        return Ptr{};
+    }
+
+    return Ptr{entry.array + offset};
+}
+
+auto map_read_region(Gba& gba, const u32 region, const ReadArray entry) -> void
+{
+    constexpr auto pages_per_region = 1U << (24 - READ_PAGE_SHIFT);
+    std::fill_n(gba.rmap + region * pages_per_region, pages_per_region, entry);
+}
+
 } // namespace
 
 auto setup_tables(Gba& gba) -> void
@@ -1146,34 +1316,42 @@ auto setup_tables(Gba& gba) -> void
     std::ranges::fill(gba.wmap, WriteArray{});
 
     // todo: check if its still worth having raw ptr / func tables
-    gba.rmap[0x2] = {gba.mem.ewram, EWRAM_MASK, Access_ALL};
-    gba.rmap[0x3] = {gba.mem.iwram, IWRAM_MASK, Access_ALL};
-    gba.rmap[0x5] = {gba.mem.pram, PRAM_MASK, Access_ALL};
-    gba.rmap[0x7] = {gba.mem.oam, OAM_MASK, Access_ALL};
-    gba.rmap[0x8] = {gba.rom, ROM_MASK, Access_ALL};
-    gba.rmap[0x9] = {gba.rom, ROM_MASK, Access_ALL};
-    gba.rmap[0xA] = {gba.rom, ROM_MASK, Access_ALL};
-    gba.rmap[0xB] = {gba.rom, ROM_MASK, Access_ALL};
-    gba.rmap[0xC] = {gba.rom, ROM_MASK, Access_ALL};
-    gba.rmap[0xD] = {gba.rom, ROM_MASK, Access_ALL};
+    map_read_region(gba, 0x2, {gba.mem.ewram, EWRAM_MASK, Access_ALL});
+    map_read_region(gba, 0x3, {gba.mem.iwram, IWRAM_MASK, Access_ALL});
+    map_read_region(gba, 0x5, {gba.mem.pram, PRAM_MASK, Access_ALL});
+    map_read_region(gba, 0x7, {gba.mem.oam, OAM_MASK, Access_ALL});
+
+    for (u32 addr = 0x08000000; addr < 0x0E000000; addr += READ_PAGE_SIZE)
+    {
+        gba.rmap[addr >> READ_PAGE_SHIFT] = get_rom_page(gba, addr);
+    }
 
     gba.wmap[0x2] = {gba.mem.ewram, EWRAM_MASK, Access_ALL};
     gba.wmap[0x3] = {gba.mem.iwram, IWRAM_MASK, Access_ALL};
     gba.wmap[0x5] = {gba.mem.pram, PRAM_MASK, Access_16bit | Access_32bit};
-    gba.wmap[0x7] = {gba.mem.oam, OAM_MASK, Access_16bit | Access_32bit};
+    // oam isn't mapped for writes so that they go through
+    // write_oam_region(), which marks the obj lines dirty.
+    // oam may also have changed here (reset, loadstate).
+    gba.obj_lines.dirty = true;
+    std::ranges::fill(gba.tile_cache.dirty, true);
 
-    // unmap rom array from 0x8 and let the func fallback handle it
+    // unmap the gpio page and let the func fallback handle it
     if (gba.gpio.rw)
     {
-        gba.rmap[0x8] = {};
+        gba.rmap[get_read_page(GPIO_DATA)] = {};
     }
 
-    // this will be handled by the function handlers
+    // this will be handled by the function handlers.
+    // todo: for roms over 16mb the eeprom is only at 0xDFFFF00, but
+    // read_eeprom_region() doesn't check the rom size yet.
     if (gba.backup.type == backup::Type::EEPROM)
     {
-        gba.rmap[0xD] = {};
+        map_read_region(gba, 0xD, {});
         gba.wmap[0xD] = {};
     }
+
+    fastmem::update(gba);
+    gba.code_page = {};
 }
 
 auto reset(Gba& gba, bool skip_bios) -> void
@@ -1192,7 +1370,96 @@ auto reset(Gba& gba, bool skip_bios) -> void
     setup_tables(gba);
 }
 
+auto get_access_timing(const u32 addr, const u8 size) -> u8
+{
+    return get_memory_timing(size >> 1, addr);
+}
+
+auto bulk_copy(Gba& gba, const u32 dst, const u32 src, const u32 len, const u8 size, const bool fixed_src) -> bool
+{
+    const auto bytes = len * size;
+    const auto src_bytes = fixed_src ? size : bytes;
+    const auto src_array = get_direct_array<false>(gba, src, src_bytes, size);
+    const auto dst_array = get_direct_array<true>(gba, dst, bytes, size);
+
+    if (!src_array || !dst_array)
+    {
+        return false;
+    }
+
+    // overlapping transfers have to be done a unit at a time
+    const auto src_ptr = reinterpret_cast<std::uintptr_t>(src_array);
+    const auto dst_ptr = reinterpret_cast<std::uintptr_t>(dst_array);
+
+    if (src_ptr < dst_ptr + bytes && dst_ptr < src_ptr + src_bytes)
+    {
+        return false;
+    }
+
+    if (fixed_src)
+    {
+        // repeat the unit to 32bits so that the fill is done a word at a time
+        u8 pattern[4];
+        std::memcpy(pattern, src_array, size);
+        std::memcpy(pattern + 4 - size, src_array, size);
+
+        u32 i = 0;
+        for (; i + 4 <= bytes; i += 4)
+        {
+            std::memcpy(dst_array + i, pattern, 4);
+        }
+
+        if (i < bytes)
+        {
+            std::memcpy(dst_array + i, pattern, bytes - i);
+        }
+    }
+    else
+    {
+        std::memcpy(dst_array, src_array, bytes);
+    }
+
+    if ((mirror_address(dst) >> 24) == 0x6)
+    {
+        gba.tile_cache.invalidate(dst & VRAM_MASK, bytes);
+    }
+
+    // each unit is a read and a write, same as going through read / write
+    gba.scheduler.tick(len * (get_memory_timing(size >> 1, src) + get_memory_timing(size >> 1, dst)));
+
+    #if INTERPRETER == INTERPRETER_JIT
+    const auto start = mirror_address(dst);
+    for (auto addr = start & ~(arm7tdmi::jit::PAGE_SIZE - 1); addr < start + bytes; addr += arm7tdmi::jit::PAGE_SIZE)
+    {
+        if (gba.jit.is_code(addr))
+        {
+            arm7tdmi::jit::invalidate(gba, addr);
+        }
+    }
+    #elif INTERPRETER == INTERPRETER_CACHED
+    if ((mirror_address(dst) >> 24) == 0x3)
+    {
+        for (auto addr = align<u32>(dst); addr < dst + bytes; addr += 4)
+        {
+            gba.cached.on_iwram_write(addr);
+        }
+    }
+    #endif
+
+    return true;
+}
+
 // all these functions are inlined
+auto read_code16(Gba& gba, u32 addr) -> u16
+{
+    return read_code<u16>(gba, addr);
+}
+
+auto read_code32(Gba& gba, u32 addr) -> u32
+{
+    return read_code<u32>(gba, addr);
+}
+
 auto read8(Gba& gba, u32 addr) -> u8
 {
     return read_internal<u8>(gba, addr);
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "fwd.hpp"
+#include <cstddef>
 
 namespace gba::mem {
 
@@ -38,10 +39,23 @@ struct WriteArray
     u8 access : 3; // only need 0-7 values
 };
 
+// the memory that opcodes are currently being fetched from, so that
+// fetches can read straight from it rather than going through the
+// tables. it's set on the first fetch outside of it, so after most
+// branches, and cleared whenever the memory map changes.
+struct CodePage
+{
+    const u8* array; // points to start
+    u32 start; // [start, start + size) of the (mirrored) address
+    u32 size; // 0 when not set
+    u8 cycles[2]; // fetch timing of 16bit, 32bit
+};
+
 struct Mem
 {
     // 256kb, 16-bit bus
-    u8 ewram[1024 * 256];
+    // page aligned (as is iwram) so fastmem can remap them.
+    alignas(4096) u8 ewram[1024 * 256];
 
     // 32kb, 32-bit bus
     u8 iwram[1024 * 32];
@@ -66,6 +80,8 @@ struct Mem
     u32 bios_openbus_value;
 };
 
+static_assert(offsetof(Mem, iwram) % 4096 == 0);
+
 enum GeneralInternalMemory
 {
     BIOS_MASK  = 0x00003FFF,
@@ -96,6 +112,16 @@ enum ExternalMemory // (Game Pak)
     ROM_SIZE = ROM_MASK + 1,
 };
 
+// the read map is split into 64kb pages, rather than a page per region,
+// so that only the page with gpio needs to be handled by a function,
+// the rest of the rom can still be read directly.
+enum ReadPage
+{
+    READ_PAGE_SHIFT = 16,
+    READ_PAGE_SIZE = 1 << READ_PAGE_SHIFT,
+    READ_PAGE_COUNT = 0x10000000 >> READ_PAGE_SHIFT,
+};
+
 enum GPIOAddr
 {
     GPIO_DATA = 0x80000C4,
@@ -388,6 +414,23 @@ enum IOAddr
 
 STATIC auto setup_tables(Gba& gba) -> void;
 STATIC auto reset(Gba& gba, bool skip_bios) -> void;
+// returns the cycles a read / write of size bytes takes at addr
+[[nodiscard]]
+STATIC auto get_access_timing(u32 addr, u8 size) -> u8;
+
+// copies len units of size (2 or 4) bytes from src to dst in one go, for
+// dma. both addresses increment, unless fixed_src is set (a fill).
+// this is only done if both ranges map straight to memory without
+// wrapping, and they don't overlap, otherwise false is returned and
+// nothing is done. the cycles ticked are the same as len reads and writes.
+[[nodiscard]]
+STATIC auto bulk_copy(Gba& gba, u32 dst, u32 src, u32 len, u8 size, bool fixed_src) -> bool;
+
+// same as read16() / read32() but for opcode fetches, see CodePage
+[[nodiscard]]
+STATIC_INLINE auto read_code16(Gba& gba, u32 addr) -> u16;
+[[nodiscard]]
+STATIC_INLINE auto read_code32(Gba& gba, u32 addr) -> u32;
 
 [[nodiscard]]
 STATIC_INLINE auto read8(Gba& gba, u32 addr) -> u8;
@@ -400,6 +443,13 @@ STATIC_INLINE auto write8(Gba& gba, u32 addr, u8 value) -> void;
 STATIC_INLINE auto write16(Gba& gba, u32 addr, u16 value) -> void;
 STATIC_INLINE auto write32(Gba& gba, u32 addr, u32 value) -> void;
 
+// returns the index into gba.rmap for addr
+[[nodiscard]]
+constexpr auto get_read_page(const u32 addr) -> u32
+{
+    return (addr & 0x0FFFFFFF) >> READ_PAGE_SHIFT;
+}
+
 template <typename T> [[nodiscard]]
 constexpr auto align(u32 addr) -> u32
 {
@@ -28,6 +28,12 @@ auto add_event(Gba& gba)
 
 #define PPU gba.ppu
 
+// the lines of frames that are skipped aren't rendered
+auto should_render(const Gba& gba) -> bool
+{
+    return gba.render_enabled && !gba.skip_frame_count;
+}
+
 auto update_period_cycles(Gba& gba) -> void
 {
     switch (PPU.period)
@@ -39,6 +45,46 @@ auto update_period_cycles(Gba& gba) -> void
     }
 };
 
+// writes the line that was just rendered to the output, if any
+auto write_output_line(Gba& gba) -> void
+{
+    const auto& output = gba.frame_output;
+
+    if (output.pixels == nullptr)
+    {
+        return;
+    }
+
+    const auto& src = PPU.pixels[REG_VCOUNT];
+    auto dst = output.pixels + (REG_VCOUNT * output.stride);
+
+    switch (output.format)
+    {
+        case PixelFormat::BGR555:
+            std::memcpy(dst, src, sizeof(src));
+            break;
+
+        case PixelFormat::RGB565:
+            for (const auto col : src)
+            {
+                const u16 value = output.lut[col & 0x7FFF];
+                std::memcpy(dst, &value, sizeof(value));
+                dst += sizeof(value);
+            }
+            break;
+
+        case PixelFormat::RGBA8888:
+        case PixelFormat::XRGB8888:
+            for (const auto col : src)
+            {
+                const u32 value = output.lut[col & 0x7FFF];
+                std::memcpy(dst, &value, sizeof(value));
+                dst += sizeof(value);
+            }
+            break;
+    }
+}
+
 // called during hblank from lines 0-227
 // this means that this is called during vblank as well
 auto on_hblank(Gba& gba)
@@ -53,7 +99,12 @@ auto on_hblank(Gba& gba)
     if (PPU.period == Period::hblank)
     {
         dma::on_hblank(gba);
-        render(gba);
+
+        if (should_render(gba)) [[likely]]
+        {
+            render(gba);
+            write_output_line(gba);
+        }
     }
 
     if (gba.hblank_callback != nullptr)
@@ -72,7 +123,15 @@ auto on_vblank(Gba& gba)
     }
     dma::on_vblank(gba);
 
-    if (gba.vblank_callback != nullptr)
+    // this is the end of the frame, so check before counting it
+    const auto rendered = should_render(gba);
+
+    if (gba.skip_frame_count)
+    {
+        gba.skip_frame_count--;
+    }
+
+    if (rendered && gba.vblank_callback != nullptr)
     {
         gba.vblank_callback(gba.userdata);
     }
@@ -187,6 +246,45 @@ auto reset(Gba& gba, bool skip_bios) -> void
 
 #undef PPU
 
+auto set_output(Gba& gba, void* pixels, const u32 stride, const PixelFormat format) -> void
+{
+    auto& output = gba.frame_output;
+
+    output.pixels = static_cast<u8*>(pixels);
+    output.stride = stride;
+
+    // frontends may change the buffer every frame, so the lut is only
+    // built when the format changes.
+    if (output.has_lut && output.format == format)
+    {
+        return;
+    }
+
+    output.format = format;
+    output.has_lut = true;
+
+    for (u32 col = 0; col < 0x8000; col++)
+    {
+        const auto r = (col >> 0) & 0x1F;
+        const auto g = (col >> 5) & 0x1F;
+        const auto b = (col >> 10) & 0x1F;
+
+        // copy the top bits into the bottom so that 31 is the max
+        const auto r8 = (r << 3) | (r >> 2);
+        const auto g8 = (g << 3) | (g >> 2);
+        const auto b8 = (b << 3) | (b >> 2);
+        const auto g6 = (g << 1) | (g >> 4);
+
+        switch (format)
+        {
+            case PixelFormat::BGR555: output.lut[col] = col; break;
+            case PixelFormat::RGB565: output.lut[col] = (r << 11) | (g6 << 5) | b; break;
+            case PixelFormat::RGBA8888: output.lut[col] = (r8 << 24) | (g8 << 16) | (b8 << 8) | 0xFF; break;
+            case PixelFormat::XRGB8888: output.lut[col] = (r8 << 16) | (g8 << 8) | b8; break;
+        }
+    }
+}
+
 auto on_event(Gba& gba) -> void
 {
     change_period(gba);
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "fwd.hpp"
+#include <algorithm>
 #include <span>
 
 namespace gba::ppu {
@@ -26,9 +27,66 @@ struct Ppu
     u16 pixels[160][240];
 };
 
+// the sprites on each line, so that rendering a line doesn't have to
+// walk all 128 oam entries. this is rebuilt on the next line rendered
+// after oam is written, which is usually once a frame.
+// not part of savestates, it's marked dirty in mem::setup_tables().
+struct ObjLines
+{
+    u8 index[160][128]; // oam index of each sprite on the line, in oam order
+    u8 count[160];
+    bool dirty;
+};
+
+enum class PixelFormat : u8
+{
+    BGR555, // 16-bit, what the gba uses
+    RGB565, // 16-bit
+    RGBA8888, // 32-bit, 0xRRGGBBAA
+    XRGB8888, // 32-bit, 0x00RRGGBB
+};
+
+// caller owned framebuffer that each line is written to once it's been
+// rendered, so frontends don't have to copy / convert the frame.
+// see Gba::set_pixels().
+struct Output
+{
+    u8* pixels;
+    u32 stride; // bytes between each line
+    PixelFormat format;
+    bool has_lut;
+    // bgr555 to format, 16-bit formats only use the lower half
+    u32 lut[0x8000];
+};
+
+// 4bpp tiles unpacked to a byte per pixel, so that a row can be read
+// directly. a tile is decoded the first time it's drawn after it's been
+// written, writes only mark the tile dirty.
+// not part of savestates, it's all marked dirty in mem::setup_tables().
+struct TileCache
+{
+    enum : u32
+    {
+        TILE_SIZE = 32, // in vram
+        TILE_COUNT = 0x18000 / TILE_SIZE,
+    };
+
+    u8 pixels[TILE_COUNT][64];
+    bool dirty[TILE_COUNT];
+
+    // offset is into vram (not mirrored)
+    auto invalidate(const u32 offset, const u32 bytes) -> void
+    {
+        std::fill(dirty + (offset / TILE_SIZE), dirty + ((offset + bytes - 1) / TILE_SIZE) + 1, true);
+    }
+};
+
 // used for debugging
 STATIC auto render_bg_mode(Gba& gba, u8 mode, u8 layer, std::span<u16> pixels) -> u8;
 
+// pixels can be nullptr to stop writing to it
+STATIC auto set_output(Gba& gba, void* pixels, u32 stride, PixelFormat format) -> void;
+
 STATIC auto get_mode(Gba& gba) -> u8;
 STATIC auto is_bitmap_mode(Gba & gba) -> bool;
 
@@ -5,6 +5,7 @@
 #include "gba.hpp"
 #include "timer.hpp"
 #include "dma.hpp"
+#include <bit>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -23,16 +24,39 @@ namespace {
 constexpr auto START_CYCLES = INT16_MAX;
 constexpr auto RESET_CYCLES = INT32_MAX;
 
+auto set_enabled(Gba& gba, const std::size_t i, const bool enabled) -> void
+{
+    gba.scheduler.entries[i].enabled = enabled;
+
+    if (enabled)
+    {
+        gba.scheduler.enabled_mask |= 1 << i;
+    }
+    else
+    {
+        gba.scheduler.enabled_mask &= ~(1 << i);
+    }
+}
+
+// returns the index of the next enabled entry starting from i, or END.
+// the mask is re-read each time as callbacks can add / remove events.
+auto next_enabled(const Gba& gba, const std::size_t i) -> std::size_t
+{
+    const u32 mask = gba.scheduler.enabled_mask & ~((1U << i) - 1);
+    return mask ? std::countr_zero(mask) : std::to_underlying(Event::END);
+}
+
 auto fire_all_expired_events(Gba& gba) -> bool
 {
     bool fire_halt = false;
 
-    for (std::size_t i = 0; i < gba.scheduler.entries.size(); i++)
+    for (auto i = next_enabled(gba, 0); i < gba.scheduler.entries.size(); i = next_enabled(gba, i + 1))
     {
         auto& entry = gba.scheduler.entries[i];
         assert(entry.delta <= 0);
+        assert(entry.enabled);
 
-        if (entry.enabled && entry.cycles <= gba.scheduler.cycles)
+        if (entry.cycles <= gba.scheduler.cycles)
         {
             if (static_cast<Event>(i) == Event::HALT) [[unlikely]]
             {
@@ -41,7 +65,7 @@ auto fire_all_expired_events(Gba& gba) -> bool
             else
             {
                 assert(static_cast<Event>(i) != Event::HALT);
-                entry.enabled = false;
+                set_enabled(gba, i, false);
 
                 if (static_cast<Event>(i) != Event::HALT && static_cast<Event>(i) != Event::DMA)
                 {
@@ -65,13 +89,11 @@ auto on_reset_event(Gba& gba) -> void
     assert(gba.scheduler.next_event_cycles >= RESET_CYCLES);
     gba.scheduler.next_event_cycles -= RESET_CYCLES;
 
-    for (auto& entry : gba.scheduler.entries)
+    for (auto i = next_enabled(gba, 0); i < gba.scheduler.entries.size(); i = next_enabled(gba, i + 1))
     {
-        if (entry.enabled)
-        {
-            assert(entry.cycles >= RESET_CYCLES);
-            entry.cycles -= RESET_CYCLES;
-        }
+        auto& entry = gba.scheduler.entries[i];
+        assert(entry.cycles >= RESET_CYCLES);
+        entry.cycles -= RESET_CYCLES;
     }
 
     // also update timers otherwise reads will be very broken
@@ -103,16 +125,16 @@ auto find_next_event(Gba& gba, bool fire)
         want_halt = fire_all_expired_events(gba);
     }
 
-    for (std::size_t i = 0; i < gba.scheduler.entries.size(); i++)
+    // ties go to the highest index
+    for (auto mask = gba.scheduler.enabled_mask; mask; mask &= mask - 1)
     {
+        const auto i = std::countr_zero(mask);
         const auto& entry = gba.scheduler.entries[i];
-        if (entry.enabled)
+
+        if (entry.cycles <= next_cycles)
         {
-            if (entry.cycles <= next_cycles)
-            {
-                next_cycles = entry.cycles;
-                index = i;
-            }
+            next_cycles = entry.cycles;
+            index = i;
         }
     }
 
@@ -139,9 +161,13 @@ auto reset(Gba& gba) -> void
 // reload events
 auto on_loadstate(Gba& gba) -> void
 {
+    // not in older states, so rebuild it
+    gba.scheduler.enabled_mask = 0;
+
     for (std::size_t i = 0; i < gba.scheduler.entries.size(); i++)
     {
         auto& entry = gba.scheduler.entries[i];
+        set_enabled(gba, i, entry.enabled);
 
         if (entry.enabled)
         {
@@ -184,7 +210,7 @@ auto fire(Gba& gba) -> void
 {
     const auto next_event = gba.scheduler.next_event;
     auto& entry = gba.scheduler.entries[std::to_underlying(next_event)];
-    entry.enabled = false;
+    set_enabled(gba, std::to_underlying(next_event), false);
     gba.scheduler.next_event = Event::END;
 
     // calculate delta so that we don't drift
@@ -223,7 +249,7 @@ auto add(Gba& gba, Event e, callback cb, u32 cycles) -> void
     auto& entry = gba.scheduler.entries[std::to_underlying(e)];
     entry.cb = cb;
     entry.cycles = (gba.scheduler.cycles + cycles) + entry.delta;
-    entry.enabled = true;
+    set_enabled(gba, std::to_underlying(e), true);
     entry.delta = 0;
 
     // check if the new event if sooner than current event
@@ -243,7 +269,7 @@ auto add(Gba& gba, Event e, callback cb, u32 cycles) -> void
 auto remove(Gba& gba, Event e) -> void
 {
     auto& entry = gba.scheduler.entries[std::to_underlying(e)];
-    entry.enabled = false;
+    set_enabled(gba, std::to_underlying(e), false);
     entry.delta = 0;
 
     // check if we are removing our current event
@@ -6,6 +6,7 @@
 #include "fwd.hpp"
 #include <cstdint>
 #include <array>
+#include <climits>
 #include <utility>
 
 namespace gba::scheduler {
@@ -53,12 +54,17 @@ struct Entry
 struct Scheduler
 {
     std::array<Entry, std::to_underlying(Event::END)> entries;
+    static_assert(std::to_underlying(Event::END) <= sizeof(u16) * CHAR_BIT);
 
     u32 cycles;
     u32 next_event_cycles;
     u32 elapsed;
     Event next_event;
     bool frame_end; // have this here because there 2+bytes of padding in this struct
+    // bit per enabled entry, so only enabled entries are checked
+    // when finding the next event. this is also in the padding,
+    // so the size of the state doesn't change.
+    u16 enabled_mask;
 
     // todo: fix this bug by ticking scheduler directly
     // try openlara menu and listen to the audio pop
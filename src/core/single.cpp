@@ -17,8 +17,10 @@
     #include "bios.cpp"
     #include "bios_hle.cpp"
     #include "scheduler.cpp"
+    #include "state.cpp"
     #include "gpio.cpp"
     #include "rtc.cpp"
+    #include "fastmem.cpp"
 
     #include "backup/backup.cpp"
     #include "backup/eeprom.cpp"
@@ -26,6 +28,7 @@
     #include "backup/sram.cpp"
 
     #include "arm7tdmi/arm7tdmi.cpp"
+    #include "arm7tdmi/idle.cpp"
 
     #if INTERPRETER == INTERPRETER_TABLE
         #include "arm7tdmi/arm/arm_table.cpp"
@@ -36,5 +39,13 @@
     #elif INTERPRETER == INTERPRETER_GOTO
         #include "arm7tdmi/arm/arm_goto.cpp"
         #include "arm7tdmi/thumb/thumb_goto.cpp"
+    #elif INTERPRETER == INTERPRETER_JIT
+        #include "arm7tdmi/jit.cpp"
+        #include "arm7tdmi/arm/arm_jit.cpp"
+        #include "arm7tdmi/thumb/thumb_jit.cpp"
+    #elif INTERPRETER == INTERPRETER_CACHED
+        #include "arm7tdmi/cached.cpp"
+        #include "arm7tdmi/arm/arm_cached.cpp"
+        #include "arm7tdmi/thumb/thumb_cached.cpp"
     #endif
 #endif
@@ -0,0 +1,285 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "state.hpp"
+#include "gba.hpp"
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+namespace gba::state {
+namespace {
+
+[[nodiscard]]
+constexpr auto fourcc(const char (&s)[5]) -> u32
+{
+    return s[0] | (s[1] << 8) | (s[2] << 16) | (s[3] << 24);
+}
+
+enum Chunk
+{
+    CHUNK_META,
+    CHUNK_SCHEDULER,
+    CHUNK_CPU,
+    CHUNK_MEM,
+    CHUNK_PPU,
+    CHUNK_APU,
+    CHUNK_DMA,
+    CHUNK_TIMER,
+    CHUNK_BACKUP,
+    CHUNK_GPIO,
+
+    CHUNK_COUNT,
+};
+
+constexpr u32 CHUNK_ID[CHUNK_COUNT] =
+{
+    /*[CHUNK_META] =*/ fourcc("META"),
+    /*[CHUNK_SCHEDULER] =*/ fourcc("SCHD"),
+    /*[CHUNK_CPU] =*/ fourcc("CPU "),
+    /*[CHUNK_MEM] =*/ fourcc("MEM "),
+    /*[CHUNK_PPU] =*/ fourcc("PPU "),
+    /*[CHUNK_APU] =*/ fourcc("APU "),
+    /*[CHUNK_DMA] =*/ fourcc("DMA "),
+    /*[CHUNK_TIMER] =*/ fourcc("TIMR"),
+    /*[CHUNK_BACKUP] =*/ fourcc("BKUP"),
+    /*[CHUNK_GPIO] =*/ fourcc("GPIO"),
+};
+
+// bump these if the struct changes in a way that keeps the same size
+constexpr u32 CHUNK_VERSION[CHUNK_COUNT] =
+{
+    /*[CHUNK_META] =*/ 1,
+    /*[CHUNK_SCHEDULER] =*/ 1,
+    /*[CHUNK_CPU] =*/ 1,
+    /*[CHUNK_MEM] =*/ 1,
+    /*[CHUNK_PPU] =*/ 1,
+    /*[CHUNK_APU] =*/ 1,
+    /*[CHUNK_DMA] =*/ 1,
+    /*[CHUNK_TIMER] =*/ 1,
+    /*[CHUNK_BACKUP] =*/ 1,
+    /*[CHUNK_GPIO] =*/ 1,
+};
+
+struct ChunkHeader
+{
+    u32 id;
+    u32 version;
+    u32 size;
+};
+
+// used to check that the state is for the loaded game
+struct Meta
+{
+    char game_title[12];
+    char game_code[4];
+    u8 complement_check;
+    backup::Type backup_type;
+    u8 _pad[2];
+};
+
+struct BackupHeader
+{
+    backup::Type type;
+    bool dirty_ram;
+    u8 _pad[2];
+};
+
+// everything but the framebuffer
+constexpr auto PPU_SIZE = offsetof(ppu::Ppu, pixels);
+
+[[nodiscard]]
+auto get_meta(const Gba& gba) -> Meta
+{
+    const Header header{gba.rom};
+    Meta meta{};
+
+    std::memcpy(meta.game_title, header.game_title, sizeof(meta.game_title));
+    std::memcpy(meta.game_code, header.game_code, sizeof(meta.game_code));
+    meta.complement_check = header.complement_check;
+    meta.backup_type = gba.backup.type;
+
+    return meta;
+}
+
+// only the data of the active backup is saved
+[[nodiscard]]
+auto get_backup_data(const Gba& gba) -> std::span<const u8>
+{
+    using enum backup::Type;
+    const auto& backup = gba.backup;
+
+    switch (backup.type)
+    {
+        case NONE: return {};
+        case EEPROM: return {reinterpret_cast<const u8*>(&backup.eeprom), sizeof(backup.eeprom)};
+        case SRAM: return {reinterpret_cast<const u8*>(&backup.sram), sizeof(backup.sram)};
+        case FLASH: [[fallthrough]];
+        case FLASH512: [[fallthrough]];
+        case FLASH1M: return {reinterpret_cast<const u8*>(&backup.flash), sizeof(backup.flash)};
+    }
+
+    std::unreachable();
+}
+
+[[nodiscard]]
+auto get_chunk_size(const Gba& gba, const Chunk chunk) -> std::size_t
+{
+    switch (chunk)
+    {
+        case CHUNK_META: return sizeof(Meta);
+        case CHUNK_SCHEDULER: return sizeof(gba.scheduler);
+        case CHUNK_CPU: return sizeof(gba.cpu);
+        case CHUNK_MEM: return sizeof(gba.mem);
+        case CHUNK_PPU: return PPU_SIZE;
+        case CHUNK_APU: return sizeof(gba.apu);
+        case CHUNK_DMA: return sizeof(gba.dma);
+        case CHUNK_TIMER: return sizeof(gba.timer);
+        case CHUNK_BACKUP: return sizeof(BackupHeader) + get_backup_data(gba).size();
+        case CHUNK_GPIO: return sizeof(gba.gpio);
+        case CHUNK_COUNT: break;
+    }
+
+    std::unreachable();
+}
+
+template<typename T> [[nodiscard]]
+auto as_bytes(const T& value) -> std::span<const u8>
+{
+    return {reinterpret_cast<const u8*>(&value), sizeof(T)};
+}
+
+auto write(std::vector<u8>& data, std::span<const u8> bytes) -> void
+{
+    data.insert(data.end(), bytes.begin(), bytes.end());
+}
+
+auto write_chunk(std::vector<u8>& data, const Chunk chunk, std::span<const u8> a, std::span<const u8> b = {}) -> void
+{
+    const ChunkHeader header{CHUNK_ID[chunk], CHUNK_VERSION[chunk], static_cast<u32>(a.size() + b.size())};
+
+    write(data, as_bytes(header));
+    write(data, a);
+    write(data, b);
+}
+
+} // namespace
+
+auto save(const Gba& gba, std::vector<u8>& data) -> void
+{
+    write(data, as_bytes(MAGIC));
+    write(data, as_bytes(VERSION));
+
+    // the callbacks are restored on load, clear them so that the
+    // same state always produces the same bytes (for diffing).
+    auto scheduler = gba.scheduler;
+    for (auto& entry : scheduler.entries)
+    {
+        entry.cb = nullptr;
+    }
+
+    const BackupHeader backup_header{gba.backup.type, gba.backup.dirty_ram, {}};
+
+    write_chunk(data, CHUNK_META, as_bytes(get_meta(gba)));
+    write_chunk(data, CHUNK_SCHEDULER, as_bytes(scheduler));
+    write_chunk(data, CHUNK_CPU, as_bytes(gba.cpu));
+    write_chunk(data, CHUNK_MEM, as_bytes(gba.mem));
+    write_chunk(data, CHUNK_PPU, as_bytes(gba.ppu).first(PPU_SIZE));
+    write_chunk(data, CHUNK_APU, as_bytes(gba.apu));
+    write_chunk(data, CHUNK_DMA, as_bytes(gba.dma));
+    write_chunk(data, CHUNK_TIMER, as_bytes(gba.timer));
+    write_chunk(data, CHUNK_BACKUP, as_bytes(backup_header), get_backup_data(gba));
+    write_chunk(data, CHUNK_GPIO, as_bytes(gba.gpio));
+}
+
+auto load(Gba& gba, std::span<const u8> data) -> bool
+{
+    u32 magic{};
+    u32 version{};
+
+    if (data.size() < sizeof(magic) + sizeof(version))
+    {
+        return false;
+    }
+
+    std::memcpy(&magic, data.data(), sizeof(magic));
+    std::memcpy(&version, data.data() + sizeof(magic), sizeof(version));
+
+    if (magic != MAGIC || version != VERSION)
+    {
+        return false;
+    }
+
+    // find all the chunks first, so that nothing is modified on error
+    std::span<const u8> chunks[CHUNK_COUNT]{};
+
+    for (auto offset = sizeof(magic) + sizeof(version); offset < data.size();)
+    {
+        ChunkHeader header{};
+
+        if (data.size() - offset < sizeof(header))
+        {
+            return false;
+        }
+
+        std::memcpy(&header, data.data() + offset, sizeof(header));
+        offset += sizeof(header);
+
+        if (data.size() - offset < header.size)
+        {
+            return false;
+        }
+
+        for (auto i = 0; i < CHUNK_COUNT; i++)
+        {
+            if (header.id == CHUNK_ID[i])
+            {
+                if (header.version != CHUNK_VERSION[i])
+                {
+                    return false;
+                }
+
+                chunks[i] = data.subspan(offset, header.size);
+            }
+        }
+
+        // unknown chunks are skipped
+        offset += header.size;
+    }
+
+    for (auto i = 0; i < CHUNK_COUNT; i++)
+    {
+        if (chunks[i].data() == nullptr || chunks[i].size() != get_chunk_size(gba, static_cast<Chunk>(i)))
+        {
+            return false;
+        }
+    }
+
+    const auto meta = get_meta(gba);
+    if (std::memcmp(chunks[CHUNK_META].data(), &meta, sizeof(meta)))
+    {
+        return false;
+    }
+
+    std::memcpy(&gba.scheduler, chunks[CHUNK_SCHEDULER].data(), sizeof(gba.scheduler));
+    std::memcpy(&gba.cpu, chunks[CHUNK_CPU].data(), sizeof(gba.cpu));
+    std::memcpy(&gba.mem, chunks[CHUNK_MEM].data(), sizeof(gba.mem));
+    std::memcpy(&gba.ppu, chunks[CHUNK_PPU].data(), PPU_SIZE);
+    std::memcpy(&gba.apu, chunks[CHUNK_APU].data(), sizeof(gba.apu));
+    std::memcpy(&gba.dma, chunks[CHUNK_DMA].data(), sizeof(gba.dma));
+    std::memcpy(&gba.timer, chunks[CHUNK_TIMER].data(), sizeof(gba.timer));
+    std::memcpy(&gba.gpio, chunks[CHUNK_GPIO].data(), sizeof(gba.gpio));
+
+    BackupHeader backup_header{};
+    std::memcpy(&backup_header, chunks[CHUNK_BACKUP].data(), sizeof(backup_header));
+    gba.backup.dirty_ram = backup_header.dirty_ram;
+
+    // the type is the same as the meta matched, and the union
+    // is at the start of the struct.
+    const auto backup_data = chunks[CHUNK_BACKUP].subspan(sizeof(backup_header));
+    std::memcpy(&gba.backup, backup_data.data(), backup_data.size());
+
+    return true;
+}
+
+} // namespace gba::state
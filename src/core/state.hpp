@@ -0,0 +1,32 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include "fwd.hpp"
+#include <span>
+#include <vector>
+
+// compact, chunked savestate format.
+// unlike gba::State, the framebuffer isn't saved and only the data of
+// the active backup type is. each chunk has its own version and size,
+// so changing the layout of one subsystem only invalidates that chunk,
+// and unknown chunks are skipped.
+//
+// all values are little endian (native), the layout is:
+//   u32 magic, u32 version
+//   chunk[] { u32 id, u32 version, u32 size, u8 data[size] }
+namespace gba::state {
+
+enum : u32
+{
+    MAGIC = 0x53414247, // "GBAS"
+    VERSION = 1,
+};
+
+// appends the state to data
+STATIC auto save(const Gba& gba, std::vector<u8>& data) -> void;
+// nothing is modified if this fails
+STATIC auto load(Gba& gba, std::span<const u8> data) -> bool;
+
+} // namespace gba::state
@@ -0,0 +1,379 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+// headless runner for running many instances across all cpu cores.
+// usage: batch <manifest> [threads]
+//
+// each line of the manifest is a job, lines starting with # are skipped.
+//   <rom> <frames> [state|-] [input|-] [output_state|-]
+//
+// the input script is a list of "<frame> <keys>" lines, where keys is
+// the hex mask of gba::Button that are held from that frame onwards.
+//
+// roms are mapped once and shared (read-only) between all jobs using them.
+#include <gba.hpp>
+#include <frontend_base.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct InputEvent
+{
+    std::uint64_t frame;
+    std::uint16_t keys;
+};
+
+struct Job
+{
+    std::string rom_path;
+    std::string state_path;
+    std::string input_path;
+    std::string output_state_path;
+    std::uint64_t frames;
+
+    // filled in before the jobs are run
+    std::span<const std::uint8_t> rom;
+    std::vector<InputEvent> input;
+};
+
+struct Result
+{
+    bool ok;
+    std::uint64_t frames;
+    // hash of every frame chained together
+    std::uint64_t frames_hash;
+    // hash of the last frame
+    std::uint64_t last_frame_hash;
+    // hash of the savestate taken at the end
+    std::uint64_t state_hash;
+    double seconds;
+};
+
+// fnv-1a
+constexpr std::uint64_t HASH_SEED = 0xCBF29CE484222325;
+
+auto hash(std::uint64_t h, const void* data, std::size_t size) -> std::uint64_t
+{
+    const auto bytes = static_cast<const std::uint8_t*>(data);
+
+    for (std::size_t i = 0; i < size; i++)
+    {
+        h ^= bytes[i];
+        h *= 0x100000001B3;
+    }
+
+    return h;
+}
+
+auto parse_manifest(const std::string& path) -> std::optional<std::vector<Job>>
+{
+    std::ifstream fs{path};
+    if (!fs.good())
+    {
+        std::printf("failed to open manifest: %s\n", path.c_str());
+        return std::nullopt;
+    }
+
+    std::vector<Job> jobs;
+    std::string line;
+
+    for (std::size_t line_num = 1; std::getline(fs, line); line_num++)
+    {
+        if (line.empty() || line.starts_with('#'))
+        {
+            continue;
+        }
+
+        std::istringstream ss{line};
+        Job job{};
+        std::string state = "-", input = "-", output = "-";
+
+        if (!(ss >> job.rom_path >> job.frames))
+        {
+            std::printf("bad manifest entry at line %zu: %s\n", line_num, line.c_str());
+            return std::nullopt;
+        }
+
+        ss >> state >> input >> output;
+        job.state_path = state == "-" ? "" : state;
+        job.input_path = input == "-" ? "" : input;
+        job.output_state_path = output == "-" ? "" : output;
+        jobs.emplace_back(std::move(job));
+    }
+
+    return jobs;
+}
+
+auto parse_input(const std::string& path) -> std::optional<std::vector<InputEvent>>
+{
+    std::ifstream fs{path};
+    if (!fs.good())
+    {
+        std::printf("failed to open input script: %s\n", path.c_str());
+        return std::nullopt;
+    }
+
+    std::vector<InputEvent> events;
+    std::uint64_t frame;
+    std::uint32_t keys;
+
+    while (fs >> std::dec >> frame >> std::hex >> keys)
+    {
+        events.emplace_back(frame, static_cast<std::uint16_t>(keys & gba::ALL));
+    }
+
+    std::ranges::stable_sort(events, {}, &InputEvent::frame);
+
+    return events;
+}
+
+auto run_job(const Job& job) -> Result
+{
+    Result result{};
+    const auto start_time = std::chrono::high_resolution_clock::now();
+
+    // the instance is ~600kb as the rom isn't copied, so use the heap
+    auto gameboy_advance = std::make_unique<gba::Gba>();
+
+    if (!gameboy_advance->loadrom_shared(job.rom))
+    {
+        std::printf("failed to load rom: %s\n", job.rom_path.c_str());
+        return result;
+    }
+
+    if (!job.state_path.empty())
+    {
+        const auto state_data = frontend::Base::loadfile(job.state_path);
+        if (!frontend::Base::loadstate_mem(*gameboy_advance, state_data))
+        {
+            std::printf("failed to loadstate: %s\n", job.state_path.c_str());
+            return result;
+        }
+    }
+
+    auto input = job.input.begin();
+    result.frames_hash = HASH_SEED;
+
+    for (std::uint64_t frame = 0; frame < job.frames; frame++)
+    {
+        for (; input != job.input.end() && input->frame <= frame; input++)
+        {
+            gameboy_advance->setkeys(gba::ALL, false);
+            gameboy_advance->setkeys(input->keys, true);
+        }
+
+        gameboy_advance->run();
+
+        const auto& pixels = gameboy_advance->ppu.pixels;
+        result.last_frame_hash = hash(HASH_SEED, pixels, sizeof(pixels));
+        result.frames_hash = hash(result.frames_hash, &result.last_frame_hash, sizeof(result.last_frame_hash));
+    }
+
+    // the chunked state is stable between runs, so it can be hashed
+    const auto state_data = frontend::Base::savestate_mem(*gameboy_advance, false);
+    result.state_hash = hash(HASH_SEED, state_data.data(), state_data.size());
+
+    if (!job.output_state_path.empty())
+    {
+        frontend::Base::dumpfile(job.output_state_path, frontend::Base::savestate_mem(*gameboy_advance, true));
+    }
+
+    const auto end_time = std::chrono::high_resolution_clock::now();
+    result.seconds = std::chrono::duration<double>(end_time - start_time).count();
+    result.frames = job.frames;
+    result.ok = true;
+
+    return result;
+}
+
+// each worker has its own queue, once empty, it steals from the
+// back of the other queues. jobs can vary a lot in length
+// (frame count, rom), so this keeps all the threads busy.
+struct WorkStealingPool
+{
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::size_t> jobs;
+    };
+
+    explicit WorkStealingPool(std::size_t thread_count) : queues(thread_count) {}
+
+    auto push(std::size_t worker, std::size_t job) -> void
+    {
+        std::scoped_lock lock{queues[worker].mutex};
+        queues[worker].jobs.push_back(job);
+    }
+
+    auto pop(std::size_t worker) -> std::optional<std::size_t>
+    {
+        // own queue first, from the front
+        {
+            auto& queue = queues[worker];
+            std::scoped_lock lock{queue.mutex};
+
+            if (!queue.jobs.empty())
+            {
+                const auto job = queue.jobs.front();
+                queue.jobs.pop_front();
+                return job;
+            }
+        }
+
+        // steal from the back of the others
+        for (std::size_t i = 1; i < queues.size(); i++)
+        {
+            auto& queue = queues[(worker + i) % queues.size()];
+            std::scoped_lock lock{queue.mutex};
+
+            if (!queue.jobs.empty())
+            {
+                const auto job = queue.jobs.back();
+                queue.jobs.pop_back();
+                return job;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    template<typename F>
+    auto run(F&& func) -> void
+    {
+        std::vector<std::jthread> threads;
+
+        for (std::size_t i = 0; i < queues.size(); i++)
+        {
+            threads.emplace_back([this, i, &func]()
+            {
+                while (const auto job = pop(i))
+                {
+                    func(*job);
+                }
+            });
+        }
+    }
+
+    std::vector<Queue> queues;
+};
+
+} // namespace
+
+auto main(int argc, char** argv) -> int
+{
+    if (argc < 2)
+    {
+        std::printf("usage: %s <manifest> [threads]\n", argv[0]);
+        return 1;
+    }
+
+    auto jobs = parse_manifest(argv[1]);
+    if (!jobs || jobs->empty())
+    {
+        return 1;
+    }
+
+    std::size_t thread_count = std::max(1U, std::thread::hardware_concurrency());
+    if (argc >= 3)
+    {
+        thread_count = std::max(1, std::atoi(argv[2]));
+    }
+
+    // map each rom once, these are shared between the instances
+    std::map<std::string, std::unique_ptr<frontend::MappedFile>> roms;
+
+    for (auto& job : *jobs)
+    {
+        auto& rom = roms[job.rom_path];
+        if (!rom)
+        {
+            rom = std::make_unique<frontend::MappedFile>(job.rom_path);
+            if (rom->span().empty())
+            {
+                std::printf("failed to read rom: %s\n", job.rom_path.c_str());
+                return 1;
+            }
+        }
+
+        job.rom = rom->span();
+
+        if (!job.input_path.empty())
+        {
+            auto input = parse_input(job.input_path);
+            if (!input)
+            {
+                return 1;
+            }
+
+            job.input = std::move(*input);
+        }
+    }
+
+    WorkStealingPool pool{thread_count};
+    std::vector<Result> results(jobs->size());
+
+    for (std::size_t i = 0; i < jobs->size(); i++)
+    {
+        pool.push(i % thread_count, i);
+    }
+
+    const auto start_time = std::chrono::high_resolution_clock::now();
+
+    pool.run([&](std::size_t i)
+    {
+        results[i] = run_job((*jobs)[i]);
+    });
+
+    const auto end_time = std::chrono::high_resolution_clock::now();
+    const auto seconds = std::chrono::duration<double>(end_time - start_time).count();
+
+    std::uint64_t total_frames{};
+    std::size_t failed{};
+
+    for (std::size_t i = 0; i < jobs->size(); i++)
+    {
+        const auto& job = (*jobs)[i];
+        const auto& result = results[i];
+
+        if (!result.ok)
+        {
+            std::printf("[%zu] %s: failed\n", i, job.rom_path.c_str());
+            failed++;
+            continue;
+        }
+
+        std::printf("[%zu] %s: frames: %llu frames_hash: %016llx last_frame_hash: %016llx state_hash: %016llx time: %.3fs\n",
+            i, job.rom_path.c_str(),
+            static_cast<unsigned long long>(result.frames),
+            static_cast<unsigned long long>(result.frames_hash),
+            static_cast<unsigned long long>(result.last_frame_hash),
+            static_cast<unsigned long long>(result.state_hash),
+            result.seconds
+        );
+
+        total_frames += result.frames;
+    }
+
+    std::printf("jobs: %zu failed: %zu threads: %zu frames: %llu time: %.3fs fps: %.1f\n",
+        jobs->size(), failed, thread_count,
+        static_cast<unsigned long long>(total_frames),
+        seconds, seconds > 0 ? total_frames / seconds : 0.0
+    );
+
+    return failed ? 1 : 0;
+}
@@ -1403,12 +1403,12 @@ auto App::on_audio_change() -> void
         return;
     }
 
-    std::scoped_lock lock0{core_mutex};
-    std::scoped_lock lock1{audio_mutex};
+    std::scoped_lock lock{core_mutex};
 
+    // the audio device is paused while audio is disabled, so whatever
+    // is left in the ring is played once it's enabled again.
     if (emu_audio_disabled)
     {
-        SDL_AudioStreamClear(audio_stream);
         gameboy_advance.set_audio_callback(nullptr, {});
     }
     else
@@ -13,6 +13,16 @@
 #include <minizip/unzip.h>
 #include <minizip/zip.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define HAS_MMAP 1
+#else
+    #define HAS_MMAP 0
+#endif
+
 namespace frontend {
 namespace {
 
@@ -234,6 +244,15 @@ auto loadzip_internal(unzFile zf) -> std::vector<std::uint8_t>
     return {};
 }
 
+// zlib compressed states start with this header
+struct CompressedStateHeader
+{
+    std::uint32_t magic;
+    std::uint32_t size; // uncompressed size
+};
+
+constexpr std::uint32_t COMPRESSED_STATE_MAGIC = 0x5A414247; // "GBAZ"
+
 const zlib_filefunc64_def zlib_filefunc64{
     .zopen64_file = minizip_open64_file_func,
     .zread_file = minizip_read_file_func,
@@ -247,6 +266,58 @@ const zlib_filefunc64_def zlib_filefunc64{
 
 } // namespace
 
+MappedFile::MappedFile(const std::string& path)
+{
+#if HAS_MMAP
+    if (!path.ends_with(".zip"))
+    {
+        if (const auto fd = open(path.c_str(), O_RDONLY); fd >= 0)
+        {
+            struct stat st{};
+            if (fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                auto data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED)
+                {
+                    this->mapped_data = data;
+                    this->mapped_size = st.st_size;
+                }
+            }
+
+            // the mapping stays valid after closing
+            close(fd);
+
+            if (this->mapped_data != nullptr)
+            {
+                return;
+            }
+        }
+    }
+#endif
+
+    this->fallback = Base::loadfile(path);
+}
+
+MappedFile::~MappedFile()
+{
+#if HAS_MMAP
+    if (this->mapped_data != nullptr)
+    {
+        munmap(this->mapped_data, this->mapped_size);
+    }
+#endif
+}
+
+auto MappedFile::span() const -> std::span<const std::uint8_t>
+{
+    if (this->mapped_data != nullptr)
+    {
+        return {static_cast<const std::uint8_t*>(this->mapped_data), this->mapped_size};
+    }
+
+    return this->fallback;
+}
+
 Base::Base(int argc, char** argv)
 {
     if (argc < 2)
@@ -417,6 +488,7 @@ auto Base::closerom() -> void
         has_rom = false;
     }
 
+    rewind.clear();
     emu_run = false;
 }
 
@@ -499,30 +571,85 @@ auto Base::savegame(const std::string& path) -> bool
     return false;
 }
 
+auto Base::loadstate_mem(gba::Gba& gba, std::span<const std::uint8_t> data) -> bool
+{
+    CompressedStateHeader header{};
+
+    if (data.size() >= sizeof(header))
+    {
+        std::memcpy(&header, data.data(), sizeof(header));
+    }
+
+    if (header.magic == COMPRESSED_STATE_MAGIC)
+    {
+        std::vector<std::uint8_t> state_data(header.size);
+        uLongf size = state_data.size();
+
+        const auto src = data.subspan(sizeof(header));
+        if (Z_OK != uncompress(state_data.data(), &size, src.data(), src.size()) || size != state_data.size())
+        {
+            std::printf("failed to decompress state\n");
+            return false;
+        }
+
+        return gba.loadstate(state_data);
+    }
+
+    // raw copy of gba::State, used before the chunked format
+    if (data.size() == sizeof(gba::State))
+    {
+        auto state = std::make_unique<gba::State>();
+        std::memcpy(state.get(), data.data(), data.size());
+        return gba.loadstate(*state);
+    }
+
+    return gba.loadstate(data);
+}
+
+auto Base::savestate_mem(const gba::Gba& gba, bool compress) -> std::vector<std::uint8_t>
+{
+    std::vector<std::uint8_t> state_data;
+    gba.savestate(state_data);
+
+    if (!compress)
+    {
+        return state_data;
+    }
+
+    const CompressedStateHeader header{COMPRESSED_STATE_MAGIC, static_cast<std::uint32_t>(state_data.size())};
+    uLongf size = compressBound(state_data.size());
+
+    std::vector<std::uint8_t> data(sizeof(header) + size);
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    if (Z_OK != compress2(data.data() + sizeof(header), &size, state_data.data(), state_data.size(), Z_BEST_SPEED))
+    {
+        std::printf("failed to compress state, saving uncompressed\n");
+        return state_data;
+    }
+
+    data.resize(sizeof(header) + size);
+    return data;
+}
+
 auto Base::loadstate(const std::string& path) -> bool
 {
     const auto state_path = create_state_path(path, state_slot);
     const auto state_data = loadfile(state_path);
-    if (!state_data.empty() && state_data.size() == sizeof(gba::State))
+    if (!state_data.empty())
     {
         std::printf("loadstate from: %s\n", state_path.c_str());
-        auto state = std::make_unique<gba::State>();
-        std::memcpy(state.get(), state_data.data(), state_data.size());
-        return gameboy_advance.loadstate(*state);
+        return loadstate_mem(gameboy_advance, state_data);
     }
     return false;
 }
 
 auto Base::savestate(const std::string& path) -> bool
 {
-    auto state = std::make_unique<gba::State>();
-    if (gameboy_advance.savestate(*state))
-    {
-        const auto state_path = create_state_path(path, state_slot);
-        std::printf("savestate to: %s\n", state_path.c_str());
-        return dumpfile(state_path, {reinterpret_cast<std::uint8_t*>(state.get()), sizeof(gba::State)});
-    }
-    return false;
+    const auto state_data = savestate_mem(gameboy_advance, compress_states);
+    const auto state_path = create_state_path(path, state_slot);
+    std::printf("savestate to: %s\n", state_path.c_str());
+    return dumpfile(state_path, state_data);
 }
 
 auto Base::set_button(gba::Button button, bool down) -> void
@@ -533,6 +660,73 @@ auto Base::set_button(gba::Button button, bool down) -> void
     }
 }
 
+auto Base::run_rewind() -> void
+{
+    if (!enabled_rewind || !has_rom)
+    {
+        return;
+    }
+
+    if (emu_rewind)
+    {
+        // the game is then run for a frame so that there's something
+        // to display, as the framebuffer isn't part of the state.
+        rewind.pop(gameboy_advance);
+    }
+    else
+    {
+        rewind.push(gameboy_advance);
+    }
+}
+
+auto Base::set_rewind_enabled(bool enable) -> void
+{
+    enabled_rewind = enable;
+
+    if (!enabled_rewind)
+    {
+        rewind.clear();
+        emu_rewind = false;
+    }
+}
+
+auto Base::run_ahead(std::uint32_t cycles) -> void
+{
+    auto& gba = gameboy_advance;
+
+    if (run_ahead_frames <= 0 || emu_rewind)
+    {
+        gba.run(cycles);
+        return;
+    }
+
+    if (!run_ahead_snapshot)
+    {
+        run_ahead_snapshot = std::make_unique<gba::Snapshot>();
+    }
+
+    const auto audio_callback = gba.audio_callback;
+
+    // only the last frame ahead is seen, so the real frame
+    // and the frames before the last aren't rendered.
+    gba.skip_frames(run_ahead_frames);
+
+    // the real frame, this is heard but not seen
+    gba.run(cycles);
+    gba.snapshot(*run_ahead_snapshot);
+
+    // the frames ahead, none are heard.
+    // the apu doesn't push samples without a callback.
+    gba.audio_callback = nullptr;
+    for (auto i = 0; i < run_ahead_frames; i++)
+    {
+        gba.run();
+    }
+
+    gba.audio_callback = audio_callback;
+    gba.restore(*run_ahead_snapshot);
+}
+
 auto Base::update_scale(int screen_width, int screen_height) -> void
 {
     const auto scale_w = screen_width / width;
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "rewind.hpp"
 #include <gba.hpp>
 #include <cstddef>
 #include <cstdint>
@@ -11,9 +12,31 @@
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <memory>
 
 namespace frontend {
 
+// read-only file that is mapped into memory (mmap), so it can be shared
+// between many instances without a copy. if mmap isn't available,
+// or the file is a zip, the file is loaded into memory instead.
+struct MappedFile
+{
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+    [[nodiscard]] auto span() const -> std::span<const std::uint8_t>;
+
+private:
+    void* mapped_data{};
+    std::size_t mapped_size{};
+    // used if the file couldn't be mapped
+    std::vector<std::uint8_t> fallback{};
+};
+
 struct Base
 {
     Base(int argc, char** argv);
@@ -34,6 +57,11 @@ public:
     static auto create_save_path(const std::string& path) -> std::string;
     static auto create_state_path(const std::string& path, int slot = 0) -> std::string;
 
+    // loads a state made by savestate_mem(), old raw states are also supported
+    static auto loadstate_mem(gba::Gba& gba, std::span<const std::uint8_t> data) -> bool;
+    // uses the compact chunked format, optionally zlib compressed
+    static auto savestate_mem(const gba::Gba& gba, bool compress) -> std::vector<std::uint8_t>;
+
 protected:
     virtual auto loadrom(const std::string& path) -> bool;
     virtual auto loadrom_mem(const std::string& path, std::span<const std::uint8_t> data) -> bool;
@@ -47,11 +75,22 @@ protected:
 
     virtual auto set_button(gba::Button button, bool down) -> void;
 
+    // call once per frame before running the game.
+    // records a state, or if rewinding, loads the last recorded state.
+    auto run_rewind() -> void;
+    auto set_rewind_enabled(bool enable) -> void;
+
+    // runs the game, then if enabled, runs ahead run_ahead_frames
+    // with the current input and displays the result, then goes back.
+    // this hides the games own input lag (usually 1-2 frames).
+    auto run_ahead(std::uint32_t cycles = 280896) -> void;
+
     virtual auto update_scale(int screen_width, int screen_height) -> void;
     virtual auto scale_with_aspect_ratio(int screen_width, int screen_height) -> std::tuple<int, int, int, int>;
 
 public:
     gba::Gba gameboy_advance{};
+    Rewind rewind{};
 
     static constexpr auto width{240};
     static constexpr auto height{160};
@@ -76,6 +115,12 @@ public:
     bool emu_fast_forward{false};
     //
     bool emu_audio_disabled{false};
+    // when true, savestates are zlib compressed
+    bool compress_states{true};
+    // number of frames to run ahead, 0 disables it
+    int run_ahead_frames{0};
+    // allocated on first use of run-ahead
+    std::unique_ptr<gba::Snapshot> run_ahead_snapshot{};
 };
 
 } // namespace frontend
@@ -330,7 +330,8 @@ auto App::run() -> void
 {
     if (emu_run)
     {
-        gameboy_advance.run();
+        run_rewind();
+        run_ahead();
     }
 }
 
@@ -7,6 +7,7 @@
 #include <trim_font.hpp>
 #include <imgui.h>
 #include <imgui_memory_editor.h>
+#include <type_traits>
 
 namespace {
 
@@ -56,7 +57,9 @@ auto mem_viewer_entry(const char* name, std::span<T> data) -> void
     if (ImGui::BeginTabItem(name))
     {
         static MemoryEditor editor;
-        editor.DrawContents(data.data(), data.size_bytes());
+        // the rom may be shared between instances, so don't allow writes
+        editor.ReadOnly = std::is_const_v<T>;
+        editor.DrawContents(const_cast<std::remove_const_t<T>*>(data.data()), data.size_bytes());
         ImGui::EndTabItem();
     }
 }
@@ -263,20 +266,21 @@ auto ImguiBase::menubar_tab_emulation() -> void
     }
     ImGui::Separator();
 
-    if (ImGui::MenuItem("Rewind Enabled", nullptr, &enabled_rewind))
+    if (bool enable = enabled_rewind; ImGui::MenuItem("Rewind Enabled", nullptr, &enable))
     {
-        // if (enabled_rewind)
-        // {
-        //     constexpr auto rewind_time = 60*60*10; // 10mins
-        //     rewind_init(&rw, compressor_zlib, compressor_zlib_size, rewind_time);
-        // }
-        // else
-        // {
-        //     rewind_close(&rw);
-        //     emu_rewind = false;
-        // }
+        set_rewind_enabled(enable);
     }
     if (ImGui::MenuItem("Rewind", "Ctrl+R", &emu_rewind, enabled_rewind)) {}
+    ImGui::Separator();
+
+    if (ImGui::BeginMenu("Run-Ahead"))
+    {
+        if (ImGui::MenuItem("Off", nullptr, run_ahead_frames == 0)) { run_ahead_frames = 0; }
+        if (ImGui::MenuItem("1 Frame", nullptr, run_ahead_frames == 1)) { run_ahead_frames = 1; }
+        if (ImGui::MenuItem("2 Frames", nullptr, run_ahead_frames == 2)) { run_ahead_frames = 2; }
+        if (ImGui::MenuItem("3 Frames", nullptr, run_ahead_frames == 3)) { run_ahead_frames = 3; }
+        ImGui::EndMenu();
+    }
 }
 
 auto ImguiBase::menubar_tab_options() -> void
@@ -294,6 +298,7 @@ auto ImguiBase::menubar_tab_tools() -> void
 {
     ImGui::MenuItem("todo...");
     ImGui::MenuItem("bit crushing", "Ctrl+A", &gameboy_advance.bit_crushing);
+    ImGui::MenuItem("idle loop skip", nullptr, &gameboy_advance.idle_loop_skip);
 }
 
 auto ImguiBase::menubar_tab_view() -> void
@@ -420,8 +425,8 @@ auto ImguiBase::im_debug_window() -> void
 
         ImGui::Separator();
         ImGui::Text("Flags: C:%u N:%u V:%u Z:%u",
-            gameboy_advance.cpu.cpsr.C, gameboy_advance.cpu.cpsr.N,
-            gameboy_advance.cpu.cpsr.V, gameboy_advance.cpu.cpsr.Z);
+            gameboy_advance.cpu.flags.c, gameboy_advance.cpu.flags.N(),
+            gameboy_advance.cpu.flags.v, gameboy_advance.cpu.flags.Z());
 
         ImGui::Text("Control: I:%u F:%u T:%u M:%u",
             gameboy_advance.cpu.cpsr.I, gameboy_advance.cpu.cpsr.F,
@@ -435,7 +440,7 @@ auto ImguiBase::im_debug_window() -> void
             mem_viewer_entry<3, std::uint8_t>("96kb vram", gameboy_advance.mem.vram);
             mem_viewer_entry<4, std::uint8_t>("1kb oam", gameboy_advance.mem.oam);
             mem_viewer_entry<5, std::uint16_t>("1kb io", gameboy_advance.mem.io);
-            mem_viewer_entry<6, std::uint8_t>("32mb rom", gameboy_advance.rom);
+            mem_viewer_entry<6, const std::uint8_t>("32mb rom", gameboy_advance.rom);
         }
         ImGui::EndTabBar();
     }
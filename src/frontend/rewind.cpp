@@ -0,0 +1,250 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "rewind.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <span>
+#include <utility>
+
+namespace frontend {
+namespace {
+
+// the delta is a list of (equal_len, diff_len, u8 diff[diff_len]),
+// where both lengths are leb128. diff is the xor of the two states.
+auto write_length(std::vector<std::uint8_t>& out, std::size_t value) -> void
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+auto read_length(std::span<const std::uint8_t> in, std::size_t& offset) -> std::size_t
+{
+    std::size_t value{};
+
+    for (auto shift = 0; offset < in.size(); shift += 7)
+    {
+        const auto byte = in[offset++];
+        value |= static_cast<std::size_t>(byte & 0x7F) << shift;
+
+        if (!(byte & 0x80))
+        {
+            break;
+        }
+    }
+
+    return value;
+}
+
+// returns the number of equal bytes starting at offset.
+// most of the state is unchanged, so compare 8 bytes at a time.
+auto count_equal(std::span<const std::uint8_t> a, std::span<const std::uint8_t> b, std::size_t offset) -> std::size_t
+{
+    const auto start = offset;
+
+    for (; offset + 8 <= a.size(); offset += 8)
+    {
+        std::uint64_t x, y;
+        std::memcpy(&x, a.data() + offset, sizeof(x));
+        std::memcpy(&y, b.data() + offset, sizeof(y));
+
+        if (x != y)
+        {
+            break;
+        }
+    }
+
+    while (offset < a.size() && a[offset] == b[offset])
+    {
+        offset++;
+    }
+
+    return offset - start;
+}
+
+auto encode(std::span<const std::uint8_t> a, std::span<const std::uint8_t> b, std::vector<std::uint8_t>& out) -> void
+{
+    assert(a.size() == b.size());
+    out.clear();
+
+    for (std::size_t offset = 0; offset < a.size();)
+    {
+        const auto equal_len = count_equal(a, b, offset);
+        offset += equal_len;
+
+        // a couple of equal bytes within a diff are cheaper to
+        // store as part of the diff than to start a new run
+        auto diff_end = offset;
+        while (diff_end < a.size())
+        {
+            if (a[diff_end] != b[diff_end])
+            {
+                diff_end++;
+            }
+            else if (const auto run = count_equal(a, b, diff_end); run < 3 && diff_end + run < a.size())
+            {
+                diff_end += run;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        write_length(out, equal_len);
+        write_length(out, diff_end - offset);
+
+        for (; offset < diff_end; offset++)
+        {
+            out.push_back(a[offset] ^ b[offset]);
+        }
+    }
+}
+
+// xors the delta into the state, turning it into the other state
+auto apply(std::span<const std::uint8_t> delta, std::span<std::uint8_t> state) -> void
+{
+    std::size_t offset{};
+
+    for (std::size_t i = 0; i < delta.size();)
+    {
+        offset += read_length(delta, i);
+        const auto diff_len = read_length(delta, i);
+
+        assert(offset + diff_len <= state.size() && i + diff_len <= delta.size());
+
+        for (std::size_t j = 0; j < diff_len; j++)
+        {
+            state[offset++] ^= delta[i++];
+        }
+    }
+}
+
+} // namespace
+
+Rewind::Rewind(std::size_t budget_, std::uint32_t interval_) : budget{budget_}, interval{std::max(1U, interval_)} {}
+
+auto Rewind::push(const gba::Gba& gba) -> void
+{
+    if (frame_counter++ % interval)
+    {
+        return;
+    }
+
+    if (ring.empty())
+    {
+        ring.resize(budget);
+    }
+
+    next.clear();
+    gba.savestate(next);
+
+    // the size only changes if a different game is loaded
+    if (current.size() != next.size())
+    {
+        entries.clear();
+        std::swap(current, next);
+        return;
+    }
+
+    encode(current, next, delta);
+    push_delta(delta);
+    std::swap(current, next);
+}
+
+auto Rewind::pop(gba::Gba& gba) -> bool
+{
+    if (current.empty())
+    {
+        return false;
+    }
+
+    if (!gba.loadstate(current))
+    {
+        clear();
+        return false;
+    }
+
+    if (!entries.empty())
+    {
+        const auto entry = entries.back();
+        entries.pop_back();
+        apply({ring.data() + entry.offset, entry.size}, current);
+    }
+
+    // so that the next state is recorded as soon as rewinding stops
+    frame_counter = 0;
+
+    return true;
+}
+
+auto Rewind::clear() -> void
+{
+    entries.clear();
+    frame_counter = 0;
+
+    // free the memory as this is only called when disabling rewind
+    // or closing the game.
+    ring = {};
+    current = {};
+    next = {};
+    delta = {};
+}
+
+auto Rewind::count() const -> std::size_t
+{
+    return entries.size() + !current.empty();
+}
+
+auto Rewind::size() const -> std::size_t
+{
+    std::size_t total{};
+
+    for (const auto& entry : entries)
+    {
+        total += entry.size;
+    }
+
+    return total;
+}
+
+auto Rewind::push_delta(std::span<const std::uint8_t> data) -> void
+{
+    // too big to ever fit, everything before this state is lost
+    if (data.size() > ring.size())
+    {
+        entries.clear();
+        return;
+    }
+
+    auto offset = entries.empty() ? 0 : entries.back().offset + entries.back().size;
+
+    // wrap around, the entries after the newest are the oldest
+    // so drop them, otherwise they'd be out of order.
+    if (offset + data.size() > ring.size())
+    {
+        while (!entries.empty() && entries.front().offset >= offset)
+        {
+            entries.pop_front();
+        }
+
+        offset = 0;
+    }
+
+    // drop the oldest entries that are about to be overwritten
+    while (!entries.empty() && entries.front().offset >= offset && entries.front().offset < offset + data.size())
+    {
+        entries.pop_front();
+    }
+
+    std::memcpy(ring.data() + offset, data.data(), data.size());
+    entries.push_back({offset, data.size()});
+}
+
+} // namespace frontend
@@ -0,0 +1,70 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <gba.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+
+namespace frontend {
+
+// records states into a fixed size ring buffer for rewinding.
+//
+// only the newest state is kept in full, every other state is stored as
+// the xor of itself and the state recorded after it. as most of the state
+// doesn't change between frames, the xor is mostly zeros, which is then
+// run length encoded. so, to go back a state, the newest delta is xored
+// into the full state and removed from the ring.
+//
+// once the ring is full, the oldest deltas are dropped.
+struct Rewind
+{
+    // 64MiB is about 5-10mins of rewind for most games
+    static constexpr std::size_t DEFAULT_BUDGET = 1024 * 1024 * 64;
+    // record a state every 4 frames
+    static constexpr std::uint32_t DEFAULT_INTERVAL = 4;
+
+    explicit Rewind(std::size_t budget = DEFAULT_BUDGET, std::uint32_t interval = DEFAULT_INTERVAL);
+
+    // call once per frame, a state is recorded every interval frames.
+    // the ring buffer is allocated on the first call.
+    auto push(const gba::Gba& gba) -> void;
+    // loads the newest state and moves back to the one before it.
+    // returns false if there are no states or the state failed to load.
+    auto pop(gba::Gba& gba) -> bool;
+    // drops all states and frees the ring buffer
+    auto clear() -> void;
+
+    // number of states that can be rewound
+    [[nodiscard]] auto count() const -> std::size_t;
+    // number of bytes used by the deltas
+    [[nodiscard]] auto size() const -> std::size_t;
+
+private:
+    struct Entry
+    {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    auto push_delta(std::span<const std::uint8_t> delta) -> void;
+
+    std::vector<std::uint8_t> ring{};
+    // oldest at the front, newest at the back
+    std::deque<Entry> entries{};
+    // the newest state in full
+    std::vector<std::uint8_t> current{};
+    // reused between calls to avoid allocating each push
+    std::vector<std::uint8_t> next{};
+    std::vector<std::uint8_t> delta{};
+
+    std::size_t budget;
+    std::uint32_t interval;
+    std::uint32_t frame_counter{};
+};
+
+} // namespace frontend
@@ -21,6 +21,11 @@ struct App final : frontend::sdl2::Sdl2Base
 
 private:
     auto render() -> void override;
+    // shows the thread times in the title once a second
+    auto update_title() -> void;
+
+    std::string title{};
+    Uint64 last_title_update{};
 };
 
 auto sdl2_audio_callback(void* user, Uint8* data, int len) -> void
@@ -70,7 +75,9 @@ App::App(int argc, char** argv) : frontend::sdl2::Sdl2Base(argc, argv)
         SDL_FreeSurface(icon);
     }
 
-    if (!init_audio(this, sdl2_audio_callback, on_audio_callback))
+    // small device buffer for low latency, the game runs on its
+    // own thread so the callback never has to wait on it.
+    if (!init_audio(this, sdl2_audio_callback, on_audio_callback, 65536, 256))
     {
         return;
     }
@@ -88,7 +95,10 @@ App::App(int argc, char** argv) : frontend::sdl2::Sdl2Base(argc, argv)
         char buf[100];
         gba::Header header{gameboy_advance.rom};
         std::sprintf(buf, "%s - [%.*s]", "BEEG YOSHI", 12, header.game_title);
+        title = buf;
         SDL_SetWindowTitle(window, buf);
+
+        start_emu_thread();
     }
     else
     {
@@ -105,6 +115,26 @@ auto App::render() -> void
 
     SDL_RenderCopy(renderer, texture, nullptr, &emu_rect);
     SDL_RenderPresent(renderer);
+
+    update_title();
+}
+
+auto App::update_title() -> void
+{
+    const auto now = SDL_GetPerformanceCounter();
+    if (title.empty() || now - last_title_update < SDL_GetPerformanceFrequency())
+    {
+        return;
+    }
+
+    last_title_update = now;
+
+    char buf[200];
+    std::snprintf(buf, sizeof(buf), "%s - emu: %.2fms ui: %.2fms audio: %.1f-%.1fms (under: %u over: %u)",
+        title.c_str(), thread_times.emu / 1000.0, thread_times.ui / 1000.0,
+        audio_watermarks.low / 1000.0, audio_watermarks.high / 1000.0,
+        audio_watermarks.underruns.load(), audio_watermarks.overruns.load());
+    SDL_SetWindowTitle(window, buf);
 }
 
 } // namespace
@@ -1,9 +1,23 @@
 // Copyright 2022 TotalJustice.
 // SPDX-License-Identifier: GPL-3.0-only
 #include "sdl2_base.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstring>
 
 namespace frontend::sdl2 {
+namespace {
+
+// how far the resample ratio can be nudged by rate control, 0.5% is
+// about 8 cents, which isn't noticeable.
+constexpr auto MAX_RATE_DELTA = 0.005;
+// how much audio to keep in the ring on top of what the next callback
+// will take, this is what covers the core producing a frame's worth of
+// samples in a burst.
+constexpr auto AUDIO_LATENCY_MS = 15;
+
+} // namespace
 
 Sdl2Base::Sdl2Base(int argc, char** argv) : frontend::Base{argc, argv}
 {
@@ -42,13 +56,16 @@ Sdl2Base::Sdl2Base(int argc, char** argv) : frontend::Base{argc, argv}
         return;
     }
 
-    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_BGR555, SDL_TEXTUREACCESS_STREAMING, width, height);
+    // RGB888 is xrgb8888, which the core converts to as it renders
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGB888, SDL_TEXTUREACCESS_STREAMING, width, height);
     if (!texture)
     {
         SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", SDL_GetError(), nullptr);
         return;
     }
 
+    gameboy_advance.set_pixels(frames.get_back(), FRAME_PITCH, gba::PixelFormat::XRGB8888);
+
     SDL_SetWindowMinimumSize(window, width, height);
 
     // setup emu rect
@@ -59,7 +76,7 @@ Sdl2Base::Sdl2Base(int argc, char** argv) : frontend::Base{argc, argv}
     running = true;
 }
 
-auto Sdl2Base::init_audio(void* user, SDL_AudioCallback sdl2_cb, gba::AudioCallback gba_cb, int sample_rate) -> bool
+auto Sdl2Base::init_audio(void* user, SDL_AudioCallback sdl2_cb, gba::AudioCallback gba_cb, int sample_rate, int samples) -> bool
 {
     if (SDL_InitSubSystem(SDL_INIT_AUDIO))
     {
@@ -72,15 +89,16 @@ auto Sdl2Base::init_audio(void* user, SDL_AudioCallback sdl2_cb, gba::AudioCallb
     aspec_wnt.format = AUDIO_S16;
     aspec_wnt.channels = 2;
     aspec_wnt.silence = 0;
-    aspec_wnt.samples = 2048;
+    aspec_wnt.samples = samples;
     aspec_wnt.padding = 0;
     aspec_wnt.size = 0;
     aspec_wnt.userdata = user;
     aspec_wnt.callback = sdl2_cb;
 
-    // allow all apsec to be changed if needed.
-    // will be coverted and resampled by audiostream.
-    audio_device = SDL_OpenAudioDevice(nullptr, 0, &aspec_wnt, &aspec_got, SDL_AUDIO_ALLOW_ANY_CHANGE);
+    // the format and channels are kept, so the callback can write the
+    // samples as is (sdl converts if the device really is different).
+    // the rate is resampled in the callback.
+    audio_device = SDL_OpenAudioDevice(nullptr, 0, &aspec_wnt, &aspec_got, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
     if (audio_device == 0)
     {
         SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", SDL_GetError(), nullptr);
@@ -95,14 +113,15 @@ auto Sdl2Base::init_audio(void* user, SDL_AudioCallback sdl2_cb, gba::AudioCallb
     // has to be power of 2
     sample_data.resize((aspec_got.samples * aspec_got.channels) & ~0x1);
 
-    audio_stream = SDL_NewAudioStream(
-        aspec_wnt.format, aspec_wnt.channels, aspec_wnt.freq,
-        aspec_got.format, aspec_got.channels, aspec_got.freq
-    );
+    resampler.step = static_cast<double>(aspec_wnt.freq) / static_cast<double>(aspec_got.freq);
+    // enough for a callback at the fastest ratio
+    const auto max_input = static_cast<std::size_t>(std::ceil(aspec_got.samples * resampler.step * (1.0 + MAX_RATE_DELTA))) + 2;
+    resampler.input.resize(max_input);
+    audio_target_fill = static_cast<std::uint32_t>(max_input + aspec_wnt.freq * AUDIO_LATENCY_MS / 1000);
 
-    if (!audio_stream)
+    if (audio_target_fill * 2 > audio_ring.capacity())
     {
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", SDL_GetError(), nullptr);
+        std::printf("[SDL-AUDIO] device buffer is too big: %u\n", aspec_got.samples);
         return false;
     }
 
@@ -111,6 +130,7 @@ auto Sdl2Base::init_audio(void* user, SDL_AudioCallback sdl2_cb, gba::AudioCallb
     std::printf("[SDL-AUDIO] channels\twant: %d \tgot: %d\n", aspec_wnt.channels, aspec_got.channels);
     std::printf("[SDL-AUDIO] samples\twant: %d \tgot: %d\n", aspec_wnt.samples, aspec_got.samples);
     std::printf("[SDL-AUDIO] size\twant: %u \tgot: %u\n", aspec_wnt.size, aspec_got.size);
+    std::printf("[SDL-AUDIO] target fill: %u\n", audio_target_fill);
 
     gameboy_advance.set_audio_callback(gba_cb, sample_data, aspec_wnt.freq);
 
@@ -119,13 +139,14 @@ auto Sdl2Base::init_audio(void* user, SDL_AudioCallback sdl2_cb, gba::AudioCallb
 
 Sdl2Base::~Sdl2Base()
 {
+    stop_emu_thread();
+
     for (auto& [_, controller] : controllers)
     {
         SDL_GameControllerClose(controller);
     }
 
     if (audio_device != 0) { SDL_CloseAudioDevice(audio_device); }
-    if (audio_stream != nullptr) { SDL_FreeAudioStream(audio_stream); }
     if (texture != nullptr) { SDL_DestroyTexture(texture); }
     if (renderer != nullptr) { SDL_DestroyRenderer(renderer); }
     if (window != nullptr) { SDL_DestroyWindow(window); }
@@ -140,8 +161,10 @@ Sdl2Base::~Sdl2Base()
 
 auto Sdl2Base::set_button(gba::Button button, bool down) -> void
 {
-    std::scoped_lock lock{core_mutex};
-    frontend::Base::set_button(button, down);
+    if (!input_queue.push({button, down}))
+    {
+        std::printf("[INPUT] queue full, dropping button: 0x%X\n", button);
+    }
 }
 
 auto Sdl2Base::loop() -> void
@@ -150,6 +173,61 @@ auto Sdl2Base::loop() -> void
     {
         step();
     }
+
+    stop_emu_thread();
+}
+
+auto Sdl2Base::start_emu_thread() -> void
+{
+    if (emu_thread.joinable())
+    {
+        return;
+    }
+
+    emu_thread_running = true;
+    emu_thread = std::thread{[this]()
+    {
+        using clock = std::chrono::steady_clock;
+        constexpr auto frame_time = std::chrono::nanoseconds{1'000'000'000 / 60};
+
+        auto next = clock::now();
+        std::chrono::microseconds busy{};
+        auto frame_count = 0;
+
+        while (emu_thread_running)
+        {
+            const auto start = clock::now();
+            run(1.0);
+            const auto end = clock::now();
+
+            busy += std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+            if (++frame_count == 60)
+            {
+                thread_times.emu = static_cast<std::uint32_t>(busy.count() / frame_count);
+                busy = {};
+                frame_count = 0;
+            }
+
+            // if the thread wasn't run for a while (ie, the pc was
+            // suspended), then don't try to catch up.
+            next += frame_time;
+            if (end - next > frame_time * 4)
+            {
+                next = end;
+            }
+
+            std::this_thread::sleep_until(next);
+        }
+    }};
+}
+
+auto Sdl2Base::stop_emu_thread() -> void
+{
+    if (emu_thread.joinable())
+    {
+        emu_thread_running = false;
+        emu_thread.join();
+    }
 }
 
 auto Sdl2Base::step() -> void
@@ -167,13 +245,26 @@ auto Sdl2Base::step() -> void
 
     poll_events();
     update_audio_device_pause_status(); // todo: remove this!
-    run(delta / div_60);
+    if (!emu_thread.joinable())
+    {
+        run(delta / div_60);
+    }
     render();
 
     now = SDL_GetPerformanceCounter();
     const auto freq = static_cast<double>(SDL_GetPerformanceFrequency());
     delta = static_cast<double>((now - start) * 1000.0) / freq;
     start = now;
+
+    static double ui_total = 0;
+    static int ui_frames = 0;
+    ui_total += delta;
+    if (++ui_frames == 60)
+    {
+        thread_times.ui = static_cast<std::uint32_t>(ui_total * 1000.0 / ui_frames);
+        ui_total = 0;
+        ui_frames = 0;
+    }
 }
 
 auto Sdl2Base::poll_events() -> void
@@ -313,14 +404,21 @@ auto Sdl2Base::poll_events() -> void
 
 auto Sdl2Base::run(double delta) -> void
 {
+    std::scoped_lock lock{core_mutex};
+
+    // applied even if the game isn't running, so that the queue doesn't fill
+    InputEvent input{};
+    while (input_queue.pop(input))
+    {
+        frontend::Base::set_button(input.button, input.down);
+    }
+
     // todo: handle menu != Menu::ROM
     if (!emu_run || !has_focus || !has_rom)
     {
         return;
     }
 
-    std::scoped_lock lock{core_mutex};
-
     // just in case something sends the main thread to sleep
     // ie, filedialog, then cap the max delta to something reasonable!
     // maybe keep track of deltas here to get an average?
@@ -329,8 +427,11 @@ auto Sdl2Base::run(double delta) -> void
     if (emu_fast_forward)
     {
         cycles *= 2;
+        // only the last frame is shown
+        gameboy_advance.skip_frames(1);
     }
-    gameboy_advance.run(cycles);
+    run_rewind();
+    run_ahead(cycles);
 }
 
 auto Sdl2Base::on_key_event(const SDL_KeyboardEvent& e) -> void
@@ -365,24 +466,28 @@ auto Sdl2Base::on_key_event(const SDL_KeyboardEvent& e) -> void
                     toggle_fullscreen();
                     break;
 
-                case SDL_SCANCODE_P:
+                case SDL_SCANCODE_P: {
+                    std::scoped_lock lock{core_mutex};
                     emu_run ^= 1;
-                    break;
+                } break;
 
-                case SDL_SCANCODE_R:
+                case SDL_SCANCODE_R: {
+                    std::scoped_lock lock{core_mutex};
                     if (enabled_rewind)
                     {
                         emu_rewind ^= 1;
                     }
-                    break;
+                } break;
 
-                case SDL_SCANCODE_S:
+                case SDL_SCANCODE_S: {
+                    std::scoped_lock lock{core_mutex};
                     savestate(rom_path);
-                    break;
+                } break;
 
-                case SDL_SCANCODE_L:
+                case SDL_SCANCODE_L: {
+                    std::scoped_lock lock{core_mutex};
                     loadstate(rom_path);
-                    break;
+                } break;
 
                 case SDL_SCANCODE_EQUALS:
                 case SDL_SCANCODE_KP_PLUS:
@@ -532,6 +637,7 @@ auto Sdl2Base::on_dropfile_event(SDL_DropEvent& e) -> void
 {
     if (e.file != nullptr)
     {
+        std::scoped_lock lock{core_mutex};
         loadrom(e.file);
         SDL_free(e.file);
     }
@@ -764,104 +870,128 @@ auto Sdl2Base::open_url(const char* url) -> void
 
 auto Sdl2Base::fill_audio_data_from_stream(Uint8* data, int len, bool tick_rom) -> void
 {
-    audio_mutex.lock();
+    auto out = reinterpret_cast<AudioFrame*>(data);
+    const auto count = static_cast<std::size_t>(len) / sizeof(AudioFrame);
+    auto& r = resampler;
 
-    const auto available = SDL_AudioStreamAvailable(audio_stream);
+    if (tick_rom && audio_ring.size() < audio_target_fill)
+    {
+        // this is only for when there's no other thread running the core,
+        // the core pushes into the ring from here, under core_mutex.
+        std::scoped_lock lock{core_mutex};
 
-    bool not_enough_samples = false;
+        if (emu_run && has_focus && has_rom && !emu_audio_disabled)
+        {
+            while (audio_ring.size() < audio_target_fill)
+            {
+                gameboy_advance.run(1000);
+            }
+        }
+    }
 
-    // if theres too little samples and ticking gba isn't an option
-    #if 0
-    if (available < len / 2 || (available < len && !tick_rom))
+    const auto fill = static_cast<std::uint32_t>(audio_ring.size());
+
+    // watermarks, reported roughly once a second
+    r.low = std::min(r.low, fill);
+    r.high = std::max(r.high, fill);
+    r.frames_since_report += count;
+    if (r.frames_since_report >= static_cast<std::uint32_t>(aspec_got.freq))
     {
-        not_enough_samples = true;
+        const auto to_us = 1'000'000.0 / aspec_wnt.freq;
+        audio_watermarks.low = static_cast<std::uint32_t>(r.low * to_us);
+        audio_watermarks.high = static_cast<std::uint32_t>(r.high * to_us);
+        r.low = UINT32_MAX;
+        r.high = 0;
+        r.frames_since_report = 0;
     }
-    #else
-    if (available < len && !tick_rom)
+
+    // after running dry, wait for the ring to fill back up rather
+    // than playing each bit as it comes in.
+    if (!r.primed)
     {
-        not_enough_samples = true;
+        if (fill < audio_target_fill)
+        {
+            std::memset(data, aspec_got.silence, len);
+            return;
+        }
+
+        r.primed = true;
+        r.fill_avg = fill;
     }
-    #endif
 
-    // too many samples behind so no point catching up, or emu isn't running.
-    #if 0
-    if (not_enough_samples || !emu_run || !has_focus || !has_rom || !running || emu_audio_disabled)
-    #else
-    if (not_enough_samples)
-    #endif
+    // rate control, take a bit more from the ring when it's over the
+    // target and a bit less when it's under, so it settles at the target.
+    r.fill_avg += (fill - r.fill_avg) * 0.05;
+    const auto error = std::clamp((r.fill_avg - audio_target_fill) / audio_target_fill, -1.0, 1.0);
+    const auto step = r.step * (1.0 + MAX_RATE_DELTA * error);
+
+    const auto end = r.pos + count * step;
+    const auto wanted = std::min(static_cast<std::size_t>(end), r.input.size());
+    const auto got = audio_ring.pop(r.input.data(), wanted);
+
+    // index 0 is the last frame from the previous callback, if the ring
+    // ran dry, the last frame there is gets repeated.
+    const auto frame_at = [&r, got](std::size_t i) -> const AudioFrame&
     {
-        audio_mutex.unlock();
-        std::memset(data, aspec_got.silence, len);
-        return;
-    }
+        return i == 0 || got == 0 ? r.last : r.input[std::min(i, got) - 1];
+    };
 
-    // this shouldn't be needed, however it causes less pops on startup
-    if (available < len)
+    // linear interpolation
+    for (std::size_t i = 0; i < count; i++)
     {
-        // need to unlock this because gba callback locks this mutex
-        audio_mutex.unlock();
-        // with this locked, nothing else writes to audiostream
-        std::scoped_lock lock{core_mutex};
+        const auto pos = r.pos + i * step;
+        const auto index = static_cast<std::size_t>(pos);
+        const auto frac = pos - index;
+        const auto& a = frame_at(index);
+        const auto& b = frame_at(index + 1);
 
-        while (SDL_AudioStreamAvailable(audio_stream) < len)
-        {
-            gameboy_advance.run(1000);
-        }
+        out[i].left = static_cast<std::int16_t>(a.left + (b.left - a.left) * frac);
+        out[i].right = static_cast<std::int16_t>(a.right + (b.right - a.right) * frac);
+    }
 
-        // need to block otherwise race condition with get()
-        audio_mutex.lock();
+    if (got)
+    {
+        r.last = r.input[got - 1];
     }
 
-    SDL_AudioStreamGet(audio_stream, data, len);
-    audio_mutex.unlock();
+    if (got < wanted)
+    {
+        audio_watermarks.underruns++;
+        r.primed = false;
+        r.pos = 0;
+    }
+    else
+    {
+        r.pos = end - wanted;
+    }
 }
 
 auto Sdl2Base::fill_stream_from_sample_data() -> void
 {
-    std::scoped_lock lock{audio_mutex};
-
-    const int max_latency = (aspec_got.size / 2) * 3;
+    const auto data = reinterpret_cast<const AudioFrame*>(sample_data.data());
+    const auto count = sample_data.size() / 2;
 
-    // safety net for if something strange happens with the sdl audio stream
-    // or the callback code where we have way too many samples, specifically about
-    // 3 frames worth. at that point, start discarding samples for a bit.
-    // not the best solution at all, but it'll do for now
-    if (max_latency > SDL_AudioStreamAvailable(audio_stream))
+    // the callback keeps the ring around the target, so it only gets
+    // this full if the audio device stopped taking samples, in which
+    // case the samples are dropped so that latency doesn't build up.
+    if (audio_ring.size() + count > audio_target_fill * 2 || audio_ring.push(data, count) != count)
     {
-        SDL_AudioStreamPut(audio_stream, sample_data.data(), sample_data.size() * 2);
+        audio_watermarks.overruns++;
     }
 }
 
 auto Sdl2Base::update_pixels_from_gba() -> void
 {
-    if (has_new_frame)
-    {
-        // std::printf("[WARNING] dropping frame, vblank called before previous frame was displayed!\n");
-        return;
-    }
-    std::memcpy(pixels, gameboy_advance.ppu.pixels, sizeof(gameboy_advance.ppu.pixels));
-    has_new_frame = true;
+    // if the last frame wasn't shown yet, it's replaced by this one
+    gameboy_advance.set_pixels(frames.publish(), FRAME_PITCH, gba::PixelFormat::XRGB8888);
 }
 
 auto Sdl2Base::update_texture_from_pixels() -> void
 {
-    core_mutex.lock();
-    if (has_new_frame)
+    if (frames.acquire())
     {
-        has_new_frame = false;
-
-        void* texture_pixels{};
-        int pitch{};
-
-        SDL_LockTexture(texture, nullptr, &texture_pixels, &pitch);
-            SDL_ConvertPixels(
-                width, height,
-                SDL_PIXELFORMAT_BGR555, pixels, width * sizeof(std::uint16_t), // src
-                SDL_PIXELFORMAT_BGR555, texture_pixels, pitch // dst
-            );
-        SDL_UnlockTexture(texture);
+        SDL_UpdateTexture(texture, nullptr, frames.get_front(), FRAME_PITCH);
     }
-    core_mutex.unlock();
 }
 
 auto Sdl2Base::update_audio_device_pause_status() -> void
@@ -4,26 +4,68 @@
 #pragma once
 
 #include "../frontend_base.hpp"
+#include "../spsc_ring.hpp"
+#include "../triple_buffer.hpp"
 
 #include <SDL.h>
+#include <atomic>
+#include <cstdint>
 #include <unordered_map>
 #include <mutex>
+#include <thread>
 
 namespace frontend::sdl2 {
 
+// average time taken per frame on each thread, in microseconds.
+// updated about once a second.
+struct ThreadTimes
+{
+    // time spent emulating a frame, should be well under 16.6ms
+    std::atomic<std::uint32_t> emu{};
+    // time between each ui loop (events + render), this is the vsync
+    // interval unless the ui thread is stalled.
+    std::atomic<std::uint32_t> ui{};
+};
+
+// lowest / highest fill of the audio ring seen by the audio callback,
+// in microseconds of audio. updated about once a second.
+struct AudioWatermarks
+{
+    std::atomic<std::uint32_t> low{};
+    std::atomic<std::uint32_t> high{};
+    // total times the ring ran dry / was too full to take more samples
+    std::atomic<std::uint32_t> underruns{};
+    std::atomic<std::uint32_t> overruns{};
+};
+
+// s16 stereo, the format the core outputs samples in
+struct AudioFrame
+{
+    std::int16_t left;
+    std::int16_t right;
+};
+
 struct Sdl2Base : frontend::Base
 {
     Sdl2Base(int argc, char** argv);
     ~Sdl2Base() override;
 
 public:
-    virtual auto init_audio(void* user, SDL_AudioCallback sdl2_cb, gba::AudioCallback gba_cb, int sample_rate = 65536) -> bool;
+    virtual auto init_audio(void* user, SDL_AudioCallback sdl2_cb, gba::AudioCallback gba_cb, int sample_rate = 65536, int samples = 2048) -> bool;
 
     auto set_button(gba::Button button, bool down) -> void override;
 
     auto loop() -> void override;
     virtual auto step() -> void;
 
+    // runs the game on its own thread, paced to 60fps, rather than in
+    // step(). the ui thread then only handles events and rendering, so
+    // it blocking (ie, file dialogs) doesn't stall the game.
+    // call once everything is setup, not available with emscripten.
+    auto start_emu_thread() -> void;
+    // called at the end of loop() and on destruction
+    auto stop_emu_thread() -> void;
+
     virtual auto poll_events() -> void;
     virtual auto run(double delta) -> void;
     virtual auto render() -> void = 0;
@@ -56,7 +98,7 @@ public:
     virtual auto open_url(const char* url) -> void;
     virtual auto rom_file_picker() -> void {}
 
-    // if tick_rom is true, when the stream doesnt have enough samples
+    // if tick_rom is true, when the ring doesnt have enough samples
     // itll run the rom until enough samples are generated.
     virtual auto fill_audio_data_from_stream(Uint8* data, int len, bool tick_rom = true) -> void;
     virtual auto fill_stream_from_sample_data() -> void;
@@ -79,16 +121,62 @@ public:
     SDL_Rect emu_rect{};
 
     SDL_AudioDeviceID audio_device{};
-    SDL_AudioStream* audio_stream{};
     SDL_AudioSpec aspec_wnt{};
     SDL_AudioSpec aspec_got{};
-    std::mutex audio_mutex{};
+    // held while the game is running, and by the ui thread when it
+    // touches the core (states, loading roms, pausing).
     std::mutex core_mutex{};
     std::vector<std::int16_t> sample_data{};
-    bool has_focus{true};
-
-    std::uint16_t pixels[160][240]{};
-    bool has_new_frame{false};
+    std::atomic<bool> has_focus{true};
+
+    struct InputEvent
+    {
+        gba::Button button;
+        bool down;
+    };
+
+    // buttons are queued by set_button() and applied at the start of
+    // run(), so input never waits on the game.
+    SpscRing<InputEvent, 256> input_queue{};
+
+    std::thread emu_thread{};
+    std::atomic<bool> emu_thread_running{false};
+    ThreadTimes thread_times{};
+
+    // samples are pushed by whatever runs the core and popped by the
+    // audio callback, which resamples them to the device rate. the
+    // ratio is nudged by how full the ring is, so that the ring stays
+    // around audio_target_fill, rather than slowly filling / draining.
+    SpscRing<AudioFrame, 16384> audio_ring{};
+    AudioWatermarks audio_watermarks{};
+    // in frames (at the core's rate)
+    std::uint32_t audio_target_fill{};
+
+    // only touched by the audio callback
+    struct Resampler
+    {
+        std::vector<AudioFrame> input{};
+        // the last frame that was popped, input follows on from this
+        AudioFrame last{};
+        // position between last and input[0]
+        double pos{};
+        // input frames per output frame, without rate control
+        double step{1.0};
+        // smoothed fill level, so bursts from the core don't wobble the ratio
+        double fill_avg{};
+        // set once the ring has filled up after running dry
+        bool primed{};
+
+        std::uint32_t low{UINT32_MAX};
+        std::uint32_t high{};
+        std::uint32_t frames_since_report{};
+    } resampler{};
+
+    // xrgb8888, the core renders into the back frame, which is handed
+    // over on vblank. the display side doesn't need core_mutex.
+    using Frame = std::uint32_t[160][240];
+    static constexpr int FRAME_PITCH = sizeof(std::uint32_t) * 240;
+    TripleBuffer<Frame> frames{};
 
     std::unordered_map<Sint32, SDL_GameController*> controllers{};
 };
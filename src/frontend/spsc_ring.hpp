@@ -0,0 +1,101 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+namespace frontend {
+
+// lock-free single producer, single consumer ring buffer.
+// one thread may push() and one (other) thread may pop(), neither
+// ever waits on the other.
+// Size has to be a power of 2.
+template<typename T, std::size_t Size>
+struct SpscRing
+{
+    static_assert(Size && !(Size & (Size - 1)), "Size has to be a power of 2");
+
+    // [producer] returns false if the ring is full
+    auto push(const T& value) -> bool
+    {
+        const auto t = tail.load(std::memory_order_relaxed);
+
+        if (t - head.load(std::memory_order_acquire) == Size)
+        {
+            return false;
+        }
+
+        buffer[t & (Size - 1)] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // [producer] pushes as many values as fit, returns how many
+    auto push(const T* values, std::size_t count) -> std::size_t
+    {
+        const auto t = tail.load(std::memory_order_relaxed);
+        count = std::min(count, Size - (t - head.load(std::memory_order_acquire)));
+
+        // may wrap around the end, so copy in (up to) 2 parts
+        const auto offset = t & (Size - 1);
+        const auto first = std::min(count, Size - offset);
+        std::copy_n(values, first, buffer + offset);
+        std::copy_n(values + first, count - first, buffer);
+
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    // [consumer] returns false if the ring is empty
+    auto pop(T& value) -> bool
+    {
+        const auto h = head.load(std::memory_order_relaxed);
+
+        if (h == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        value = buffer[h & (Size - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // [consumer] pops up to count values, returns how many
+    auto pop(T* values, std::size_t count) -> std::size_t
+    {
+        const auto h = head.load(std::memory_order_relaxed);
+        count = std::min(count, tail.load(std::memory_order_acquire) - h);
+
+        const auto offset = h & (Size - 1);
+        const auto first = std::min(count, Size - offset);
+        std::copy_n(buffer + offset, first, values);
+        std::copy_n(buffer, count - first, values + first);
+
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    // number of values in the ring. as the other side keeps going, the
+    // consumer can pop at least this many, and the producer can push at
+    // least capacity() - size().
+    [[nodiscard]] auto size() const -> std::size_t
+    {
+        const auto h = head.load(std::memory_order_acquire);
+        return tail.load(std::memory_order_acquire) - h;
+    }
+
+    [[nodiscard]] static constexpr auto capacity() -> std::size_t { return Size; }
+
+private:
+    T buffer[Size]{};
+    // both only ever go up, so full is tail - head == Size.
+    // on separate cache lines as each is written by a different thread.
+    alignas(64) std::atomic<std::size_t> head{}; // written by the consumer
+    alignas(64) std::atomic<std::size_t> tail{}; // written by the producer
+};
+
+} // namespace frontend
@@ -0,0 +1,61 @@
+// Copyright 2022 TotalJustice.
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace frontend {
+
+// lock-free triple buffer for handing frames from one thread to another.
+//
+// the writer owns the back buffer and the reader owns the front buffer,
+// the third is the newest finished frame waiting to be shown. both sides
+// only ever swap their buffer with that one, so the writer never waits
+// for the reader, and the reader always gets the newest finished frame.
+// a frame that's finished before the last one was shown is replaced.
+//
+// only one thread may call the writer functions, and only one (can be
+// the same) may call the reader functions.
+template<typename T>
+struct TripleBuffer
+{
+    // [writer] the frame to write to
+    [[nodiscard]] auto get_back() -> T& { return frames[back]; }
+
+    // [writer] hands over the back frame and returns the next one
+    auto publish() -> T&
+    {
+        back = ready.exchange(back | NEW_FRAME, std::memory_order_acq_rel) & INDEX_MASK;
+        return frames[back];
+    }
+
+    // [reader] moves the newest frame to the front, returns false
+    // if there isn't a new frame since the last call.
+    auto acquire() -> bool
+    {
+        if (!(ready.load(std::memory_order_relaxed) & NEW_FRAME))
+        {
+            return false;
+        }
+
+        front = ready.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    // [reader] the frame to show
+    [[nodiscard]] auto get_front() const -> const T& { return frames[front]; }
+
+private:
+    static constexpr std::uint32_t INDEX_MASK = 0x3;
+    // set in ready when the writer has handed over a frame
+    static constexpr std::uint32_t NEW_FRAME = 0x4;
+
+    T frames[3]{};
+    std::uint32_t back{0};
+    std::atomic<std::uint32_t> ready{1};
+    std::uint32_t front{2};
+};
+
+} // namespace frontend